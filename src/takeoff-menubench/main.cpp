@@ -0,0 +1,114 @@
+/**
+ * @file /src/takeoff-menubench/main.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ */
+#include <stdio.h>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+#include <KDE/KComponentData>
+#include "../takeoff/metrics/Metrics.h"
+#include "../takeoff/model/menu/MenuBackend.h"
+#include "../takeoff/model/menu/XdgMenuBackend.h"
+#include "../takeoff/model/menu/qtxdg/xdgdesktopfile.h"
+
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/// Loads of each backend if the number isn't given.
+const int DEFAULT_RUNS = 10;
+
+/// Names of the backends, in the order of MenuBackend::Type.
+const char *BACKEND_NAMES[MenuBackend::NUM_TYPES] = { "xdg", "ksycoca" };
+
+/// Option to read the xdg menu from takeoff-menud, like the applet.
+const char *SHARED_OPTION = "--shared";
+
+/**
+ * Prints the usage of the benchmark.
+ * @return The exit code.
+ */
+int usage()
+{
+    fprintf(stderr, "Usage: takeoff-menubench [%s] [runs]\n", SHARED_OPTION);
+    return 1;
+}
+
+}
+
+
+/**
+ * Loads the menu with each backend several times and prints the load times,
+ * to compare the backends on this system.
+ * Usage: takeoff-menubench [--shared] [runs]
+ *
+ * By default the xdg menu files are resolved in each run, even if
+ * takeoff-menud is running. With --shared the menu is read from takeoff-menud
+ * when it is running, like the applet does. The desktop files cached by a run
+ * are dropped before the next one, so every run parses them.
+ *
+ * The first load of each backend fills the caches of this process only: the
+ * files could already be in the page cache of the system, so it is reported
+ * as the first load in the process and not as a cold load. To measure a cold
+ * load, drop the page cache before running the benchmark.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    KComponentData componentData("takeoff-menubench");
+
+    QStringList args = app.arguments().mid(1);
+    bool shared = args.removeAll(SHARED_OPTION) > 0;
+    int runs = DEFAULT_RUNS;
+    if (args.size() > 1)
+        return usage();
+    if (args.size() == 1) {
+        bool ok;
+        runs = args.at(0).toInt(&ok);
+        if (!ok || runs < 1)
+            return usage();
+    }
+
+    QTextStream out(stdout);
+    int ret = 0;
+    for (int type=0; type<MenuBackend::NUM_TYPES; type++) {
+        for (int n=0; n<runs; n++) {
+            MenuBackend *backend = MenuBackend::create((MenuBackend::Type)type);
+            if (type == MenuBackend::XDG) {
+                static_cast<XdgMenuBackend*>(backend)
+                        ->setSharedMenuEnabled(shared);
+            }
+
+            bool loaded = backend->read();
+            delete backend;
+            XdgDesktopFileCache::clear();
+
+            if (!loaded) {
+                out << BACKEND_NAMES[type] << ": the menu can't be loaded\n";
+                ret = 1;
+                break;
+            }
+        }
+    }
+
+    out << Metrics::toString();
+    return ret;
+}
@@ -0,0 +1,288 @@
+/**
+ * @file /src/takeoff-menud/MenuDaemon.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  MenuDaemon
+ */
+#include "MenuDaemon.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QRegExp>
+#include <QtNetwork/QLocalServer>
+#include <QtNetwork/QLocalSocket>
+#include <QtXml/QDomDocument>
+#include "../takeoff/model/menu/SharedMenu.h"
+#include "../takeoff/model/menu/qtxdg/xdgdesktopfile.h"
+#include "../takeoff/model/menu/qtxdg/xdgdirs.h"
+#include "../takeoff/model/menu/qtxdg/xdgmenu.h"
+
+// ************************************************************************** //
+// **********             STATIC METHODS AND VARIABLES             ********** //
+// ************************************************************************** //
+
+const char *MenuDaemon::SNAPSHOT_PREFIX = "takeoff-menud-";
+
+void MenuDaemon::removeStaleSnapshots()
+{
+    // The POSIX shared memory objects are the files of /dev/shm in Linux
+    QDir shm("/dev/shm");
+    QStringList names = shm.entryList(QStringList(
+            QString(SNAPSHOT_PREFIX) + "*"), QDir::Files);
+    foreach (const QString &name, names) {
+        if (QFileInfo(shm, name).ownerId() == ::getuid())
+            ::shm_unlink(QFile::encodeName("/" + name).constData());
+    }
+}
+
+void MenuDaemon::remove(Snapshot *snapshot)
+{
+    if (!snapshot->name.isEmpty())
+        ::shm_unlink(QFile::encodeName(snapshot->name).constData());
+    delete snapshot->menu;
+    delete snapshot;
+}
+
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+MenuDaemon::MenuDaemon(QObject *parent)
+        : QObject(parent),
+          server(new QLocalServer(this)),
+          published(0)
+{
+    connect(this->server, SIGNAL(newConnection()),
+            this, SLOT(acceptConnections()));
+}
+
+MenuDaemon::~MenuDaemon()
+{
+    foreach (Snapshot *snapshot, this->snapshots)
+        remove(snapshot);
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC METHODS                    ********** //
+// ************************************************************************** //
+
+bool MenuDaemon::listen(const QString &socketPath, gid_t group)
+{
+    // The socket is created only for the user, and opened to the group once
+    // it belongs to it
+    QLocalServer::removeServer(socketPath);
+    mode_t mask = ::umask(0177);
+    bool listening = this->server->listen(socketPath);
+    ::umask(mask);
+    if (!listening) {
+        qWarning("takeoff-menud: can't listen on %s: %s",
+                qPrintable(socketPath),
+                qPrintable(this->server->errorString()));
+        return false;
+    }
+
+    QByteArray path = QFile::encodeName(socketPath);
+    if (group != (gid_t)-1 && (::chown(path.constData(), (uid_t)-1, group) != 0
+            || ::chmod(path.constData(), 0660) != 0)) {
+        qWarning("takeoff-menud: can't give the socket to the group");
+        this->server->close();
+        return false;
+    }
+
+    return true;
+}
+
+
+// ************************************************************************** //
+// **********                    PRIVATE SLOTS                     ********** //
+// ************************************************************************** //
+
+void MenuDaemon::acceptConnections()
+{
+    while (this->server->hasPendingConnections()) {
+        QLocalSocket *socket = this->server->nextPendingConnection();
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    }
+}
+
+void MenuDaemon::readRequest()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(this->sender());
+    QByteArray request;
+    if (socket == NULL || !SharedMenu::takeFrame(socket, &request))
+        return;
+
+    quint32 version;
+    QString menuFile;
+    QString language;
+    QStringList dataDirs;
+    QStringList configDirs;
+    QStringList environments;
+    QDataStream in(request);
+    in >> version >> menuFile >> language >> dataDirs >> configDirs
+            >> environments;
+
+    quint32 status = SharedMenu::NOT_SERVED;
+    const Snapshot *snapshot = NULL;
+    if (in.status() == QDataStream::Ok && version == SharedMenu::VERSION
+            && this->isServed(menuFile, language, dataDirs, configDirs,
+                    environments)) {
+        snapshot = this->getSnapshot(QFileInfo(menuFile).canonicalFilePath(),
+                language, environments);
+        status = (snapshot != NULL) ? SharedMenu::OK : SharedMenu::FAILED;
+    }
+
+    QByteArray answer;
+    QDataStream out(&answer, QIODevice::WriteOnly);
+    out << status
+            << ((snapshot != NULL) ? snapshot->name : QString())
+            << ((snapshot != NULL) ? snapshot->watchPaths : QStringList());
+    socket->write(SharedMenu::frame(answer));
+    socket->disconnectFromServer();
+}
+
+
+// ************************************************************************** //
+// **********                   PRIVATE METHODS                    ********** //
+// ************************************************************************** //
+
+const MenuDaemon::Snapshot *MenuDaemon::getSnapshot(const QString &menuFile,
+        const QString &language, const QStringList &environments)
+{
+    QString key = menuFile + '\n' + language + '\n' + environments.join(";");
+    Snapshot *snapshot = this->snapshots.value(key, NULL);
+    if (snapshot != NULL && !snapshot->menu->isOutDated()) {
+        snapshot->lastUse = QDateTime::currentMSecsSinceEpoch();
+        return snapshot;
+    }
+
+    // The desktop files of an outdated menu could have changed too
+    if (snapshot != NULL) {
+        this->snapshots.remove(key);
+        remove(snapshot);
+        XdgDesktopFileCache::clear();
+    }
+
+    snapshot = new Snapshot;
+    snapshot->menu = new XdgMenu;
+    snapshot->menu->environments() << environments;
+    snapshot->menu->setLanguage(language);
+    snapshot->lastUse = QDateTime::currentMSecsSinceEpoch();
+    if (!snapshot->menu->read(menuFile)
+            || (snapshot->name = this->publish(snapshot->menu)).isEmpty()) {
+        remove(snapshot);
+        return NULL;
+    }
+    snapshot->watchPaths = snapshot->menu->watchPaths();
+
+    // Forget the least recently used menu
+    if (this->snapshots.size() >= MAX_SNAPSHOTS) {
+        QString oldest;
+        qint64 oldestUse = 0;
+        QHashIterator<QString, Snapshot*> it(this->snapshots);
+        while (it.hasNext()) {
+            it.next();
+            if (oldest.isEmpty() || it.value()->lastUse < oldestUse) {
+                oldest = it.key();
+                oldestUse = it.value()->lastUse;
+            }
+        }
+        remove(this->snapshots.take(oldest));
+    }
+
+    this->snapshots.insert(key, snapshot);
+    return snapshot;
+}
+
+QString MenuDaemon::publish(const XdgMenu *menu)
+{
+    QByteArray xml = menu->xml().toByteArray(-1);
+    QString name = QString("/%1%2-%3").arg(SNAPSHOT_PREFIX)
+            .arg(::getpid()).arg(this->published++);
+    QByteArray encodedName = QFile::encodeName(name);
+
+    int fd = ::shm_open(encodedName.constData(), O_RDWR | O_CREAT | O_EXCL,
+            0644);
+    if (fd == -1)
+        return QString();
+
+    // The umask could have removed the read permission of the other users
+    SharedMenu::SnapshotHeader header;
+    header.magic   = SharedMenu::MAGIC;
+    header.version = SharedMenu::VERSION;
+    header.size    = xml.size();
+    size_t size = sizeof(header) + xml.size();
+
+    void *data = MAP_FAILED;
+    if (::fchmod(fd, 0644) == 0 && ::ftruncate(fd, size) == 0)
+        data = ::mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        ::shm_unlink(encodedName.constData());
+        return QString();
+    }
+
+    ::memcpy(data, &header, sizeof(header));
+    ::memcpy((char*)data + sizeof(header), xml.constData(), xml.size());
+    ::munmap(data, size);
+    return name;
+}
+
+bool MenuDaemon::isServed(const QString &menuFile, const QString &language,
+        const QStringList &dataDirs, const QStringList &configDirs,
+        const QStringList &environments) const
+{
+    // A session with other directories has other desktop files
+    if (dataDirs != XdgDirs::dataDirs() || configDirs != XdgDirs::configDirs())
+        return false;
+
+    // Only the system menu files are read, the requests come from any user
+    QString canonicalFile = QFileInfo(menuFile).canonicalFilePath();
+    if (canonicalFile.isEmpty())
+        return false;
+
+    bool systemFile = false;
+    foreach (const QString &configDir, configDirs) {
+        QString menusDir = QFileInfo(configDir + "/menus").canonicalFilePath();
+        if (!menusDir.isEmpty() && canonicalFile.startsWith(menusDir + "/"))
+            systemFile = true;
+    }
+    if (!systemFile)
+        return false;
+
+    // Every language and environment is a different menu, keep them sane
+    QRegExp word("[A-Za-z0-9_.@-]{0,64}");
+    if (!word.exactMatch(language) || environments.size() > 8)
+        return false;
+    foreach (const QString &environment, environments) {
+        if (!word.exactMatch(environment))
+            return false;
+    }
+
+    return true;
+}
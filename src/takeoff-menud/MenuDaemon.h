@@ -0,0 +1,146 @@
+/**
+ * @file /src/takeoff-menud/MenuDaemon.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  MenuDaemon
+ */
+#ifndef MENUD_MENUDAEMON_H
+#define MENUD_MENUDAEMON_H
+
+#include <sys/types.h>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+class QLocalServer;
+class XdgMenu;
+
+/**
+ * Resolves the system menu once for all the sessions of the host and shares
+ * it with them, see SharedMenu. The menu is resolved for each language and
+ * environments requested and published as a shared memory object that the
+ * other users can only read. The menu is resolved again when its files change.
+ *
+ * The user directories are never read: the sessions apply them in-process.
+ */
+class MenuDaemon : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * Default constructor.
+     * @param parent The parent of the object.
+     */
+    MenuDaemon(QObject *parent = 0);
+
+    /**
+     * Destructor. Removes the shared memory objects.
+     */
+    virtual ~MenuDaemon();
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Starts listening for requests. The socket can only be used by the user
+     * of the helper and the members of the group.
+     * @param  socketPath The path of the socket.
+     * @param  group      The group of the users that are served, or -1 to serve
+     *                    only the user of the helper.
+     * @return If the socket was created.
+     */
+    bool listen(const QString &socketPath, gid_t group);
+
+    /**
+     * Removes the shared memory objects left by a previous helper that didn't
+     * finish properly.
+     */
+    static void removeStaleSnapshots();
+
+private slots:
+
+    /// Accepts the pending connections.
+    void acceptConnections();
+
+    /// Answers the request of a connection, when it is complete.
+    void readRequest();
+
+private:
+
+    /// A resolved menu and the shared memory object where it is published.
+    struct Snapshot {
+        XdgMenu *menu;
+        QString name;
+        QStringList watchPaths;
+        qint64 lastUse;
+    };
+
+    /**
+     * Returns the snapshot of a menu, resolving and publishing it if it is
+     * not published or it is outdated.
+     * @param  menuFile     The menu file.
+     * @param  language     The language of the translations.
+     * @param  environments The environments that display the entries.
+     * @return The snapshot or NULL on error.
+     */
+    const Snapshot *getSnapshot(const QString &menuFile,
+            const QString &language, const QStringList &environments);
+
+    /**
+     * Writes the XML of a menu in a new shared memory object.
+     * @param  menu The resolved menu.
+     * @return The name of the object or an empty string on error.
+     */
+    QString publish(const XdgMenu *menu);
+
+    /**
+     * Deletes a snapshot and removes its shared memory object. The sessions
+     * that are reading it keep their mapping.
+     * @param snapshot The snapshot.
+     */
+    static void remove(Snapshot *snapshot);
+
+    /**
+     * Indicates if a request can be served: the directories must be the
+     * system ones and the menu file must be a system file.
+     * @return If the request is valid.
+     */
+    bool isServed(const QString &menuFile, const QString &language,
+            const QStringList &dataDirs, const QStringList &configDirs,
+            const QStringList &environments) const;
+
+    //--------------------------------------------------------------------------
+
+    /// Prefix of the names of the shared memory objects.
+    static const char *SNAPSHOT_PREFIX;
+
+    /// Maximum number of snapshots, the least recently used is removed.
+    static const int MAX_SNAPSHOTS = 16;
+
+    /// Socket where the requests are received.
+    QLocalServer *server;
+
+    /// Published snapshots, by menu file, language and environments.
+    QHash<QString, Snapshot*> snapshots;
+
+    /// Number of published snapshots, to name them.
+    int published;
+
+};
+
+#endif // MENUD_MENUDAEMON_H
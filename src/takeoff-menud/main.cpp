@@ -0,0 +1,150 @@
+/**
+ * @file /src/takeoff-menud/main.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <grp.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSocketNotifier>
+#include <QtCore/QStringList>
+#include "MenuDaemon.h"
+#include "../takeoff/model/menu/SharedMenu.h"
+
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/// Pipe written by the handler of the termination signals.
+int signalPipe[2] = { -1, -1 };
+
+/**
+ * Handler of the termination signals. The event loop is quit from the pipe,
+ * so the empty directory and the shared memory objects are removed.
+ * @param signal The signal.
+ */
+void handleSignal(int /*signal*/)
+{
+    int savedErrno = errno;
+    char byte = 1;
+    ssize_t ret = ::write(signalPipe[1], &byte, 1);
+    Q_UNUSED(ret);
+    errno = savedErrno;
+}
+
+/**
+ * Quits the application when SIGTERM, SIGINT or SIGHUP is received.
+ * @param  app The application.
+ * @return If the handlers were installed.
+ */
+bool installSignalHandlers(QCoreApplication *app)
+{
+    if (::pipe(signalPipe) != 0)
+        return false;
+
+    for (int n=0; n<2; n++) {
+        ::fcntl(signalPipe[n], F_SETFD, FD_CLOEXEC);
+        ::fcntl(signalPipe[n], F_SETFL, O_NONBLOCK);
+    }
+
+    QSocketNotifier *notifier = new QSocketNotifier(signalPipe[0],
+            QSocketNotifier::Read, app);
+    QObject::connect(notifier, SIGNAL(activated(int)), app, SLOT(quit()));
+
+    struct sigaction action;
+    ::memset(&action, 0, sizeof(action));
+    action.sa_handler = handleSignal;
+    ::sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+
+    int signals[] = { SIGTERM, SIGINT, SIGHUP };
+    for (uint n=0; n<sizeof(signals)/sizeof(signals[0]); n++) {
+        if (::sigaction(signals[n], &action, NULL) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+}
+
+
+/**
+ * Starts the helper that resolves the system menu for all the Takeoff
+ * sessions of the host. Usage: takeoff-menud [socket path [group]]
+ *
+ * Only the members of the group can connect to the socket. Without a group
+ * only the user of the helper can.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    if (!installSignalHandlers(&app)) {
+        qWarning("takeoff-menud: can't handle the termination signals");
+        return 1;
+    }
+
+    QStringList args = app.arguments();
+    QString socketPath = (args.size() > 1) ? args.at(1)
+            : SharedMenu::getSocketPath();
+
+    gid_t group = (gid_t)-1;
+    if (args.size() > 2) {
+        struct group *entry = ::getgrnam(
+                QFile::encodeName(args.at(2)).constData());
+        if (entry == NULL) {
+            qWarning("takeoff-menud: unknown group %s",
+                    qPrintable(args.at(2)));
+            return 1;
+        }
+        group = entry->gr_gid;
+    }
+
+    // Only the system part of the menu is shared, so the user directories of
+    // the helper are replaced by an empty one
+    QByteArray emptyDir = QFile::encodeName(QDir::tempPath()
+            + "/takeoff-menud-XXXXXX");
+    if (::mkdtemp(emptyDir.data()) == NULL) {
+        qWarning("takeoff-menud: can't create an empty directory");
+        return 1;
+    }
+    ::setenv("XDG_DATA_HOME", emptyDir.constData(), 1);
+    ::setenv("XDG_CONFIG_HOME", emptyDir.constData(), 1);
+
+    MenuDaemon::removeStaleSnapshots();
+
+    // The directory is removed on every exit after it is created, the
+    // termination signals quit the event loop
+    int ret = 1;
+    {
+        MenuDaemon daemon;
+        if (daemon.listen(socketPath, group))
+            ret = app.exec();
+    }
+
+    ::rmdir(emptyDir.constData());
+    return ret;
+}
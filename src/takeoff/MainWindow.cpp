@@ -22,19 +22,27 @@
 #include <QtCore/QList>
 #include <QtCore/QTranslator>
 #include <QtCore/QProcess>
+#include <QtCore/QTimer>
 #include <QtGui/QApplication>
 #include <QtGui/QDesktopWidget>
 #include <QtGui/QAction>
+#include <QtGui/QGraphicsLinearLayout>
 #include <KDE/KIcon>
 #include <KDE/KConfigDialog>
+#include <KDE/KRun>
+#include <KDE/KUrl>
 #include <KDE/Plasma/ToolTipContent>
 #include <KDE/Plasma/ToolTipManager>
 #include "takeoff_widget/TakeoffWidget.h"
 #include "takeoff_widget/Launcher.h"
 #include "model/favorites/Favorites.h"
+#include "model/history/LaunchHistory.h"
+#include "model/launch/Prefetcher.h"
 #include "model/menu/Menu.h"
 #include "model/config/Config.h"
 #include "model/config/ConfigForm.h"
+#include "metrics/MetricsDumper.h"
+#include "trace/Trace.h"
 
 using namespace Plasma;
 using namespace Takeoff;
@@ -54,17 +62,19 @@ K_EXPORT_PLASMA_APPLET(takeoff, MainWindow)
 
 MainWindow::MainWindow(QObject *parent, const QVariantList &args)
         : Plasma::PopupApplet(parent, args),
-          takeoff(new TakeoffWidget(this))
+          container(NULL),
+          takeoff(NULL)
 {
+    TAKEOFF_TRACE_SPAN("MainWindow::MainWindow");
+
     // Plasmoid aspect
     this->setBackgroundHints(DefaultBackground);
     this->setAspectRatioMode(Plasma::IgnoreAspectRatio);
 
-    // Hide the popup when an application is launched
-    connect(this->takeoff, SIGNAL(clicked()), this, SLOT(hidePopup()));
-
-    // Load the configuration
-    this->loadConfig();
+    // The widgets and the menu are created when the popup is opened, or when
+    // the mouse is over the icon, so only the icon is loaded now
+    this->setAcceptHoverEvents(true);
+    this->loadIcon();
 
     // Tooltip
     Plasma::ToolTipContent data;
@@ -73,8 +83,8 @@ MainWindow::MainWindow(QObject *parent, const QVariantList &args)
     data.setImage(this->popupIcon().pixmap(IconSize(KIconLoader::Desktop)));
     Plasma::ToolTipManager::self()->setContent(this, data);
 
-    connect(this->takeoff, SIGNAL(hideWindow()),
-            this, SLOT(slotHide()));
+    // Dump the metrics when they are asked through D-Bus
+    MetricsDumper::getInstance();
 }
 
 
@@ -84,51 +94,96 @@ MainWindow::MainWindow(QObject *parent, const QVariantList &args)
 
 void MainWindow::loadConfig()
 {
-    Config::loadConfig();
-    Menu::loadMenu();
+    TAKEOFF_TRACE_SPAN("MainWindow::loadConfig");
+    Config::Fields fields = Config::loadConfig();
+
+    Config::Fields gridFields = Config::NUM_ROWS_FIELD
+            | Config::NUM_COLUMNS_FIELD
+            | Config::LAUNCHER_SIZE_FIELD
+            | Config::SEPARATION_BETWEEN_LAUNCHERS_FIELD;
+    Config::Fields tabsFields = Config::SHOW_FAVORITES_FIELD
+            | Config::SHOW_MOST_USED_FIELD
+            | Config::SHOW_ALL_APPLICATIONS_FIELD
+            | Config::SHOW_XDG_MENU_FIELD;
+
+    if (fields & Config::ICON_FIELD)
+        this->loadIcon();
+
+    if (this->container != NULL
+            && (fields & (gridFields | Config::FULL_SCREEN_FIELD)))
+        this->loadSize();
+
+    // The rest of the configuration is applied when the widgets are created
+    if (this->takeoff == NULL)
+        return;
+
+    bool menuChanged = true;
+    if (fields & Config::MENU_BACKEND_FIELD)
+        Menu::loadMenu();
+    else
+        menuChanged = Menu::loadMenuIfOutDated();
+
+    // The categories or their applications have changed
+    if (menuChanged || (fields & tabsFields)) {
+        this->loadTabs();
+        return;
+    }
 
-    this->takeoff->reset();
+    // Only the existing launchers have to change. Paging them again also
+    // creates the pages of the new kind of grid
+    if (fields & (gridFields | Config::SINGLE_PAINTER_GRID_FIELD))
+        this->takeoff->repage();
 
-    Config *cfg = Config::getInstance();
+    if (fields & Config::SHOW_ICON_TEXT_FIELD)
+        this->takeoff->updateLaunchers();
 
-    // Set the popup icon
-    this->setPopupIcon(KIcon(cfg->getSettings(Config::ICON).toString()));
+    if (fields & (Config::SHOW_BACKGROUND_IMAGE_FIELD
+            | Config::BACKGROUND_IMAGE_FIELD))
+        this->takeoff->update();
+}
 
-    // Set fullscreen mode or not
-    if (cfg->getSettings(Config::FULL_SCREEN).toBool()) {
-        this->takeoff->setMinimumWidth(QApplication::desktop()->width());
-        this->takeoff->setMinimumHeight(QApplication::desktop()->height());
-    } else {
-        int numRows      = cfg->getSettings(Config::NUM_ROWS).toInt();
-        int numColumns   = cfg->getSettings(Config::NUM_COLUMNS).toInt();
-        int launcherSize = cfg->getSettings(Config::LAUNCHER_SIZE).toInt();
-        int sep =cfg->getSettings(Config::SEPARATION_BETWEEN_LAUNCHERS).toInt();
+void MainWindow::reloadMenu()
+{
+    // The menu is read when the widgets are created
+    if (this->takeoff == NULL)
+        return;
 
-        this->takeoff->setMinimumWidth((numColumns+2)*(launcherSize+sep));
-        this->takeoff->setMaximumWidth((numColumns+2)*(launcherSize+sep));
+    Menu::loadMenu();
+    this->loadTabs();
+}
 
-        this->takeoff->setMinimumHeight(numRows*(launcherSize+sep) + 200);
-        this->takeoff->setMaximumHeight(numRows*(launcherSize+sep) + 200);
-    }
+void MainWindow::createTakeoff()
+{
+    if (this->takeoff != NULL)
+        return;
 
-    // Load different categories
-    if (cfg->getSettings(Config::SHOW_FAVORITES).toBool())
-        this->loadFavorites();
+    TAKEOFF_TRACE_SPAN("MainWindow::createTakeoff");
+    QGraphicsWidget *container = this->graphicsWidget();
+    this->takeoff = new TakeoffWidget(container);
+    ((QGraphicsLinearLayout*)container->layout())->addItem(this->takeoff);
 
-    if (cfg->getSettings(Config::SHOW_ALL_APPLICATIONS).toBool())
-        this->loadAllApplications();
+    // Hide the popup when an application is launched
+    connect(this->takeoff, SIGNAL(clicked()), this, SLOT(hidePopup()));
+    connect(this->takeoff, SIGNAL(hideWindow()),
+            this, SLOT(slotHide()));
 
-    if (cfg->getSettings(Config::SHOW_XDG_MENU).toBool())
-        this->loadXdgMenu();
+    this->loadTabs();
 }
 
 void MainWindow::launchMenuEditor() const
 {
     QProcess* myProcess = new QProcess();
-    connect(myProcess, SIGNAL(finished(int)), this, SLOT(loadConfig()));
+    connect(myProcess, SIGNAL(finished(int)), this, SLOT(reloadMenu()));
     myProcess->start("kmenuedit --nofork");
 }
 
+void MainWindow::dumpMetrics() const
+{
+    QString path = MetricsDumper::getInstance()->dump();
+    if (!path.isEmpty())
+        KRun::runUrl(KUrl(path), "text/plain", NULL);
+}
+
 void MainWindow::slotHide()
 {
     hidePopup();
@@ -141,12 +196,59 @@ void MainWindow::slotHide()
 
 QGraphicsWidget *MainWindow::graphicsWidget()
 {
+    // PopupApplet asks for the widget while it is initialized, so it gets an
+    // empty placeholder with the size of the popup
+    if (this->container == NULL) {
+        this->container = new QGraphicsWidget(this);
+        QGraphicsLinearLayout *l = new QGraphicsLinearLayout(this->container);
+        l->setContentsMargins(0, 0, 0, 0);
+        this->container->setLayout(l);
+        this->loadSize();
+    }
+
+    return this->container;
+}
+
+void MainWindow::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
+{
+    Plasma::PopupApplet::hoverEnterEvent(event);
+
+    // Create the widgets once the hover event is processed
+    if (this->takeoff == NULL
+            && Config::getInstance()->getValues().prewarmOnHover)
+        QTimer::singleShot(0, this, SLOT(createTakeoff()));
+}
+
+void MainWindow::constraintsEvent(Plasma::Constraints constraints)
+{
+    Plasma::PopupApplet::constraintsEvent(constraints);
+
+    if (!(constraints & Plasma::FormFactorConstraint) || this->takeoff != NULL)
+        return;
+
+    // The placeholder is shown inline instead of the icon
+    Plasma::FormFactor form = this->formFactor();
+    if (form == Plasma::Planar || form == Plasma::MediaCenter) {
+        this->createTakeoff();
+        Prefetcher::getInstance()->prefetch();
+    }
+}
+
+void MainWindow::popupEvent(bool show)
+{
+    Plasma::PopupApplet::popupEvent(show);
+
+    if (!show)
+        return;
+
+    // The widgets are created the first time, unless the hover already did it
+    this->createTakeoff();
+
     // If "remember last tab" is not checked go to the first tab (favorites)
-    Config *cfg = Config::getInstance();
-    this->takeoff->setFirstTab(!cfg->getSettings(
-            Config::REMEMBER_LAST_TAB).toBool());
+    const Config::Values &cfg = Config::getInstance()->getValues();
+    this->takeoff->setFirstTab(!cfg.rememberLastTab);
 
-    return this->takeoff;
+    Prefetcher::getInstance()->prefetch();
 }
 
 void MainWindow::createConfigurationInterface(KConfigDialog *parent)
@@ -164,8 +266,12 @@ QList<QAction*> MainWindow::contextualActions()
     connect(launchMenuEditor, SIGNAL(triggered()),
             this, SLOT(launchMenuEditor()));
 
+    QAction* dumpMetrics = new QAction(i18n("Dump metrics"), this);
+    connect(dumpMetrics, SIGNAL(triggered()), this, SLOT(dumpMetrics()));
+
     QList<QAction*> ret;
     ret.append(launchMenuEditor);
+    ret.append(dumpMetrics);
     return ret;
 }
 
@@ -174,52 +280,112 @@ QList<QAction*> MainWindow::contextualActions()
 // **********                   PRIVATE METHODS                    ********** //
 // ************************************************************************** //
 
+void MainWindow::loadIcon()
+{
+    TAKEOFF_TRACE_SPAN("MainWindow::loadIcon");
+    this->setPopupIcon(KIcon(Config::getInstance()->getValues().icon));
+}
+
+void MainWindow::loadSize()
+{
+    const Config::Values &cfg = Config::getInstance()->getValues();
+
+    // Set fullscreen mode or not
+    if (cfg.fullScreen) {
+        this->container->setMinimumWidth(QApplication::desktop()->width());
+        this->container->setMinimumHeight(QApplication::desktop()->height());
+        this->container->setMaximumWidth(QWIDGETSIZE_MAX);
+        this->container->setMaximumHeight(QWIDGETSIZE_MAX);
+    } else {
+        int numRows      = cfg.numRows;
+        int numColumns   = cfg.numColumns;
+        int launcherSize = cfg.launcherSize;
+        int sep          = cfg.separationBetweenLaunchers;
+
+        this->container->setMinimumWidth((numColumns+2)*(launcherSize+sep));
+        this->container->setMaximumWidth((numColumns+2)*(launcherSize+sep));
+
+        this->container->setMinimumHeight(numRows*(launcherSize+sep) + 200);
+        this->container->setMaximumHeight(numRows*(launcherSize+sep) + 200);
+    }
+}
+
+void MainWindow::loadTabs()
+{
+    TAKEOFF_TRACE_SPAN("MainWindow::loadTabs");
+    const Config::Values &cfg = Config::getInstance()->getValues();
+    this->takeoff->reset();
+
+    // Load different categories
+    if (cfg.showFavorites)
+        this->loadFavorites();
+
+    if (cfg.showMostUsed)
+        this->loadMostUsed();
+
+    if (cfg.showAllApplications)
+        this->loadAllApplications();
+
+    if (cfg.showXdgMenu)
+        this->loadXdgMenu();
+}
+
 void MainWindow::loadFavorites()
 {
+    TAKEOFF_TRACE_SPAN("MainWindow::loadFavorites");
     this->takeoff->addMenuCategory(KIcon("favorites"), i18n("Favorites"));
 
     Favorites *favorites = Favorites::getInstance();
-    QList<Launcher*> favoritesList = favorites->getFavorites();
-
-    foreach (Launcher *launcher, favoritesList) {
-        this->takeoff->addMenuLauncher(this->takeoff->getNumMenuCategories()-1,
-                launcher);
-    }
+    this->takeoff->addMenuLaunchers(this->takeoff->getNumMenuCategories()-1,
+            favorites->getFavorites());
 }
 
-void MainWindow::loadAllApplications()
+void MainWindow::loadMostUsed()
 {
-    // Add the "All Applications" tab
-    this->takeoff->addMenuCategory(KIcon("applications-other"),
-            i18n("All Applications"));
+    TAKEOFF_TRACE_SPAN("MainWindow::loadMostUsed");
+    this->takeoff->addMenuCategory(KIcon("view-history"), i18n("Most used"));
+
+    // Show one panel with the applications with the highest frecency
+    const Config::Values &cfg = Config::getInstance()->getValues();
+    int panelSize = cfg.numRows * cfg.numColumns;
 
-    // Load the launchers
     Menu* menu = Menu::getInstance();
     QList<Launcher*> *allApplications = menu->getAllApplications();
+    QStringList mostUsed = LaunchHistory::getInstance()->getMostUsed(panelSize);
 
-    for (int n=0; n<allApplications->length(); n++) {
-        Launcher *launcher = new Launcher(*(allApplications->at(n)));
-        this->takeoff->addMenuLauncher(this->takeoff->getNumMenuCategories()-1,
-                launcher);
+    QList<LauncherData> launchers;
+    foreach (const QString &desktopFile, mostUsed) {
+        int index = menu->getApplicationIndex(desktopFile);
+        if (index != -1)
+            launchers.append(allApplications->at(index)->getData());
     }
+
+    this->takeoff->addMenuLaunchers(this->takeoff->getNumMenuCategories()-1,
+            launchers);
+}
+
+void MainWindow::loadAllApplications()
+{
+    TAKEOFF_TRACE_SPAN("MainWindow::loadAllApplications");
+    // Add the "All Applications" tab, the launchers are created when it is
+    // shown
+    Menu* menu = Menu::getInstance();
+    this->takeoff->addLazyMenuCategory(KIcon("applications-other"),
+            i18n("All Applications"), 0, menu->getAllApplications()->length());
 }
 
 void MainWindow::loadXdgMenu()
 {
+    TAKEOFF_TRACE_SPAN("MainWindow::loadXdgMenu");
     Menu* menu = Menu::getInstance();
     QList< QPair<QString, KIcon>* > *categories = menu->getCategories();
 
     for (int n=0; n<categories->length(); n++) {
-        // Load the categories tabs
+        // Load the categories tabs, the launchers are created when they are
+        // shown
         QPair<QString, KIcon> *pair = categories->at(n);
-        this->takeoff->addMenuCategory(pair->second, pair->first);
-
-        // Load the launchers
-        QList<Launcher*> *launchers = menu->getCategoriesApplications(n);
-        for (int l=0; l<launchers->length(); l++) {
-            Launcher *launcher = new Launcher(*(launchers->at(l)));
-            this->takeoff->addMenuLauncher(
-                    this->takeoff->getNumMenuCategories()-1, launcher);
-        }
+        QPair<int, int> range = menu->getCategoryRange(n);
+        this->takeoff->addLazyMenuCategory(pair->second, pair->first,
+                range.first, range.second);
     }
 }
@@ -48,11 +48,19 @@ public:
 
     /**
      * Inherit from Plasma::PopupApplet. Returns the widget that must be show in
-     * the popup window.
+     * the popup window. It is an empty placeholder until the popup is opened,
+     * the mouse enters the icon or the widget is shown inline, see
+     * createTakeoff().
      * @return The widget.
      */
     virtual QGraphicsWidget *graphicsWidget();
 
+    /**
+     * Inherit from QGraphicsItem. Creates the widgets when the mouse enters the
+     * icon, so they are ready when the popup is opened.
+     */
+    virtual void hoverEnterEvent(QGraphicsSceneHoverEvent *event);
+
     /**
      * Inherit from Plasma::Applet. Creates the configuration interface, adding
      * the Takeoff configuration GUI.
@@ -65,21 +73,62 @@ public:
      */
     virtual QList<QAction*> contextualActions();
 
+protected:
+
+    /**
+     * Inherit from Plasma::Applet. On the desktop and in the media center the
+     * widget is shown inline and the popup is never opened, so the widgets are
+     * created as soon as the form factor is known.
+     * @param constraints The constraints that have changed.
+     */
+    virtual void constraintsEvent(Plasma::Constraints constraints);
+
+    /**
+     * Inherit from Plasma::PopupApplet. Creates the widgets the first time the
+     * popup is shown and prefetches the most used applications.
+     * @param show If the popup is shown or hidden.
+     */
+    virtual void popupEvent(bool show);
+
 private slots:
 
-    /// Loads the configuration using the private methods load*
+    /**
+     * Reloads the configuration and updates only the parts affected by the
+     * changed values.
+     */
     void loadConfig();
 
+    /// Reloads the menu and creates the tabs again.
+    void reloadMenu();
+
+    /// Creates the widgets and loads the menu, if they aren't created yet.
+    void createTakeoff();
+
     /// Launch the KDE menu editor.
     void launchMenuEditor() const;
 
+    /// Writes the metrics to a file and opens it.
+    void dumpMetrics() const;
+
     void slotHide();
 
 private:
 
+    /// Sets the popup icon.
+    void loadIcon();
+
+    /// Sets the size of the popup, see graphicsWidget().
+    void loadSize();
+
+    /// Creates all the tabs using the private methods load*
+    void loadTabs();
+
     /// Loads the favorites applications.
     void loadFavorites();
 
+    /// Loads the most used applications.
+    void loadMostUsed();
+
     /// Load all applications in the same tab.
     void loadAllApplications();
 
@@ -88,7 +137,10 @@ private:
 
     //--------------------------------------------------------------------------
 
-    /// The widget with the menu and the search dialog.
+    /// Widget shown in the popup, it contains the TakeoffWidget once created.
+    QGraphicsWidget *container;
+
+    /// The widget with the menu and the search dialog, NULL until it is used.
     Takeoff::TakeoffWidget *takeoff;
 };
 
@@ -0,0 +1,100 @@
+/**
+ * @file /src/takeoff/metrics/Histogram.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  Histogram
+ */
+#include "Histogram.h"
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+Histogram::Histogram()
+        : count(0),
+          max(0)
+{
+    for (int n=0; n<NUM_BUCKETS; n++)
+        this->buckets[n] = 0;
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC METHODS                    ********** //
+// ************************************************************************** //
+
+void Histogram::record(qint64 value)
+{
+    int sample = (int)qBound(Q_INT64_C(0), value, Q_INT64_C(0x7FFFFFFF));
+
+    // Index of the highest bit set, the last bucket counts the greater values
+    int bucket = 0;
+    for (int v=sample; v > 0 && bucket < NUM_BUCKETS-1; v >>= 1)
+        bucket++;
+
+    this->buckets[bucket].fetchAndAddRelaxed(1);
+    this->count.fetchAndAddRelaxed(1);
+
+    // Other thread could raise the maximum between the read and the swap
+    int current = this->max;
+    while (sample > current && !this->max.testAndSetRelaxed(current, sample))
+        current = this->max;
+}
+
+int Histogram::getCount() const
+{
+    return this->count;
+}
+
+qint64 Histogram::getPercentile(int percentile) const
+{
+    // Sum the buckets instead of reading the count, so they are consistent
+    qint64 total = 0;
+    for (int n=0; n<NUM_BUCKETS; n++)
+        total += int(this->buckets[n]);
+    if (total == 0)
+        return 0;
+
+    qint64 target = (total * qBound(0, percentile, 100) + 99) / 100;
+    qint64 accumulated = 0;
+    for (int n=0; n<NUM_BUCKETS; n++) {
+        accumulated += int(this->buckets[n]);
+        if (accumulated >= target && accumulated > 0)
+            return qMin(Q_INT64_C(1) << n, this->getMax());
+    }
+
+    return this->getMax();
+}
+
+qint64 Histogram::getMax() const
+{
+    return int(this->max);
+}
+
+QString Histogram::toString(const char *unit) const
+{
+    if (this->getCount() == 0)
+        return "no samples";
+
+    return QString("n=%1 p50<=%3%2 p90<=%4%2 p99<=%5%2 max=%6%2")
+            .arg(this->getCount())
+            .arg(unit)
+            .arg(this->getPercentile(50))
+            .arg(this->getPercentile(90))
+            .arg(this->getPercentile(99))
+            .arg(this->getMax());
+}
@@ -0,0 +1,101 @@
+/**
+ * @file /src/takeoff/metrics/Histogram.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  Histogram
+ */
+#ifndef METRICS_HISTOGRAM_H
+#define METRICS_HISTOGRAM_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QString>
+
+/**
+ * Histogram with power of two buckets, from 1 to about 2^31. Recording a
+ * sample is constant time, doesn't allocate memory and doesn't lock, so it can
+ * be done from any thread while other thread reads the histogram. The reads
+ * are not a snapshot: a sample recorded meanwhile may be counted or not.
+ */
+class Histogram
+{
+
+public:
+
+    /**
+     * Default constructor. Creates an empty histogram.
+     */
+    Histogram();
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Adds a sample to the histogram.
+     * @param value The value, usually a latency in microseconds.
+     */
+    void record(qint64 value);
+
+    /**
+     * Returns the number of samples.
+     * @return The number of samples.
+     */
+    int getCount() const;
+
+    /**
+     * Returns the upper bound of the bucket that contains the specified
+     * percentile.
+     * @param  percentile The percentile, from 0 to 100.
+     * @return The value or 0 if the histogram is empty.
+     */
+    qint64 getPercentile(int percentile) const;
+
+    /**
+     * Returns the highest recorded value.
+     * @return The value or 0 if the histogram is empty.
+     */
+    qint64 getMax() const;
+
+    /**
+     * Returns a line with the number of samples and some percentiles, to be
+     * printed in the logs.
+     * @param  unit Suffix of the values.
+     * @return The summary.
+     */
+    QString toString(const char *unit = "us") const;
+
+    //--------------------------------------------------------------------------
+
+    /// Number of buckets. The bucket n counts the values in [2^(n-1), 2^n).
+    static const int NUM_BUCKETS = 32;
+
+private:
+
+    /// Samples in each bucket.
+    QAtomicInt buckets[NUM_BUCKETS];
+
+    /// Number of samples.
+    QAtomicInt count;
+
+    /// Highest value, saturated to the range of an int.
+    QAtomicInt max;
+
+    // Hide copy constructors
+    Histogram(const Histogram&);
+    const Histogram &operator = (const Histogram&);
+
+};
+
+#endif // METRICS_HISTOGRAM_H
@@ -0,0 +1,140 @@
+/**
+ * @file /src/takeoff/metrics/Metrics.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  Metrics
+ */
+#include "Metrics.h"
+#include <QtCore/QDateTime>
+#include <QtCore/QStringList>
+
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/// Returns the hit rate of a cache, as a percentage.
+QString hitRate(int hits, int misses)
+{
+    if (hits + misses == 0)
+        return "-";
+
+    return QString("%1%").arg(100.0 * hits / (hits + misses), 0, 'f', 1);
+}
+
+}
+
+
+// ************************************************************************** //
+// **********             STATIC METHODS AND VARIABLES             ********** //
+// ************************************************************************** //
+
+const char *Metrics::COUNTER_NAMES[Metrics::NUM_COUNTERS] = {
+    "desktop_file_cache.hits",
+    "desktop_file_cache.misses",
+    "icon_cache.hits",
+    "icon_cache.misses",
+    "menu_cache.hits",
+    "menu_cache.misses",
+    "shared_menu.hits",
+    "shared_menu.fallbacks",
+    "shared_icons.hits",
+    "shared_icons.misses",
+    "search.cancelled"
+};
+
+const char *Metrics::HISTOGRAM_NAMES[Metrics::NUM_DISTRIBUTIONS][2] = {
+    { "search.latency", "us" },
+    { "search.results", ""   },
+    { "launch.spawn_latency", "us" },
+    { "launch.fallback_latency", "us" },
+    { "menu.xdg.first_load_in_process_latency", "us" },
+    { "menu.xdg.repeated_load_latency", "us" },
+    { "menu.ksycoca.first_load_in_process_latency", "us" },
+    { "menu.ksycoca.repeated_load_latency", "us" }
+};
+
+const char *Metrics::SUBSYSTEM_NAMES[Metrics::NUM_SUBSYSTEMS] = {
+    "xdg_menu_dom",
+    "desktop_file_cache",
+    "icon_cache",
+    "launchers",
+    "favorites"
+};
+
+QAtomicInt Metrics::counters[Metrics::NUM_COUNTERS];
+Histogram  Metrics::histograms[Metrics::NUM_DISTRIBUTIONS];
+QAtomicInt Metrics::objects[Metrics::NUM_SUBSYSTEMS];
+QAtomicInt Metrics::bytes[Metrics::NUM_SUBSYSTEMS];
+
+int Metrics::getCounter(Counter counter)
+{
+    return Metrics::counters[counter];
+}
+
+const Histogram &Metrics::getHistogram(Distribution distribution)
+{
+    return Metrics::histograms[distribution];
+}
+
+int Metrics::getObjects(Subsystem subsystem)
+{
+    return Metrics::objects[subsystem];
+}
+
+int Metrics::getBytes(Subsystem subsystem)
+{
+    return Metrics::bytes[subsystem];
+}
+
+QString Metrics::toString()
+{
+    QStringList lines;
+    lines.append(QString("# Takeoff metrics, %1")
+            .arg(QDateTime::currentDateTime().toString(Qt::ISODate)));
+
+    for (int n=0; n<NUM_COUNTERS; n++)
+        lines.append(QString("%1 %2").arg(COUNTER_NAMES[n])
+                .arg(getCounter((Counter)n)));
+
+    lines.append(QString("desktop_file_cache.hit_rate %1").arg(hitRate(
+            getCounter(DESKTOP_FILE_CACHE_HITS),
+            getCounter(DESKTOP_FILE_CACHE_MISSES))));
+    lines.append(QString("icon_cache.hit_rate %1").arg(hitRate(
+            getCounter(ICON_CACHE_HITS), getCounter(ICON_CACHE_MISSES))));
+    lines.append(QString("menu_cache.hit_rate %1").arg(hitRate(
+            getCounter(MENU_CACHE_HITS), getCounter(MENU_CACHE_MISSES))));
+    lines.append(QString("shared_icons.hit_rate %1").arg(hitRate(
+            getCounter(SHARED_ICON_HITS), getCounter(SHARED_ICON_MISSES))));
+
+    for (int n=0; n<NUM_DISTRIBUTIONS; n++)
+        lines.append(QString("%1 %2").arg(HISTOGRAM_NAMES[n][0])
+                .arg(histograms[n].toString(HISTOGRAM_NAMES[n][1])));
+
+    qint64 totalBytes = 0;
+    for (int n=0; n<NUM_SUBSYSTEMS; n++) {
+        lines.append(QString("memory.%1 objects=%2 bytes=%3")
+                .arg(SUBSYSTEM_NAMES[n])
+                .arg(getObjects((Subsystem)n))
+                .arg(getBytes((Subsystem)n)));
+        totalBytes += getBytes((Subsystem)n);
+    }
+    lines.append(QString("memory.total bytes=%1").arg(totalBytes));
+
+    return lines.join("\n") + "\n";
+}
@@ -0,0 +1,197 @@
+/**
+ * @file /src/takeoff/metrics/Metrics.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  Metrics
+ */
+#ifndef METRICS_METRICS_H
+#define METRICS_METRICS_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QString>
+#include "Histogram.h"
+
+/**
+ * Registry of the counters and histograms of the hot operations, to know if a
+ * slow Takeoff is waiting for the disk, the icon theme or the search, and of
+ * the memory held by each subsystem. Every metric is a fixed slot updated with
+ * atomic operations, so they can be updated from any thread without locks or
+ * allocations.
+ *
+ * The registry is dumped with MetricsDumper.
+ */
+class Metrics
+{
+
+public:
+
+    /// Counters. The names are in COUNTER_NAMES.
+    enum Counter {
+        DESKTOP_FILE_CACHE_HITS,
+        DESKTOP_FILE_CACHE_MISSES,
+        ICON_CACHE_HITS,
+        ICON_CACHE_MISSES,
+        MENU_CACHE_HITS,
+        MENU_CACHE_MISSES,
+        SHARED_MENU_HITS,
+        SHARED_MENU_FALLBACKS,
+        SHARED_ICON_HITS,
+        SHARED_ICON_MISSES,
+        SEARCHES_CANCELLED,
+        NUM_COUNTERS
+    };
+
+    /// Histograms. The names and units are in HISTOGRAM_NAMES.
+    enum Distribution {
+        SEARCH_LATENCY,
+        SEARCH_RESULTS,
+        SPAWN_LATENCY,
+        FALLBACK_LATENCY,
+        XDG_MENU_FIRST_LOAD,
+        XDG_MENU_REPEATED_LOAD,
+        KSYCOCA_MENU_FIRST_LOAD,
+        KSYCOCA_MENU_REPEATED_LOAD,
+        NUM_DISTRIBUTIONS
+    };
+
+    /// Owners of the accounted memory. The names are in SUBSYSTEM_NAMES.
+    enum Subsystem {
+        XDG_MENU_DOM,
+        DESKTOP_FILE_CACHE,
+        ICON_CACHE,
+        LAUNCHERS,
+        FAVORITES,
+        NUM_SUBSYSTEMS
+    };
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Adds a value to a counter.
+     * @param counter The counter.
+     * @param value   The value to add, negative to subtract.
+     */
+    static inline void add(Counter counter, int value = 1)
+    {
+        Metrics::counters[counter].fetchAndAddRelaxed(value);
+    }
+
+    /**
+     * Adds a sample to a histogram.
+     * @param distribution The histogram.
+     * @param value        The sample.
+     */
+    static inline void record(Distribution distribution, qint64 value)
+    {
+        Metrics::histograms[distribution].record(value);
+    }
+
+    /**
+     * Accounts an object allocated by a subsystem.
+     * @param subsystem The owner of the object.
+     * @param bytes     The estimated size of the object, see sizeOf().
+     */
+    static inline void allocate(Subsystem subsystem, int bytes)
+    {
+        Metrics::objects[subsystem].fetchAndAddRelaxed(1);
+        Metrics::bytes[subsystem].fetchAndAddRelaxed(bytes);
+    }
+
+    /**
+     * Accounts an object freed by a subsystem.
+     * @param subsystem The owner of the object.
+     * @param bytes     The size passed to allocate().
+     */
+    static inline void release(Subsystem subsystem, int bytes)
+    {
+        Metrics::objects[subsystem].fetchAndAddRelaxed(-1);
+        Metrics::bytes[subsystem].fetchAndAddRelaxed(-bytes);
+    }
+
+    /**
+     * Returns the size of a string, including the reserved characters. The
+     * shared strings are counted by each owner.
+     * @param  text The string.
+     * @return The size in bytes.
+     */
+    static inline int sizeOf(const QString &text)
+    {
+        return sizeof(QString) + text.capacity() * sizeof(QChar);
+    }
+
+    /**
+     * Returns the value of a counter.
+     * @param  counter The counter.
+     * @return The value.
+     */
+    static int getCounter(Counter counter);
+
+    /**
+     * Returns a histogram.
+     * @param  distribution The histogram.
+     * @return The histogram.
+     */
+    static const Histogram &getHistogram(Distribution distribution);
+
+    /**
+     * Returns the number of live objects of a subsystem.
+     * @param  subsystem The subsystem.
+     * @return The number of objects.
+     */
+    static int getObjects(Subsystem subsystem);
+
+    /**
+     * Returns the memory held by a subsystem. The sizes are estimated from the
+     * data of the objects, the private data of Qt and the allocator overhead
+     * are not counted.
+     * @param  subsystem The subsystem.
+     * @return The size in bytes.
+     */
+    static int getBytes(Subsystem subsystem);
+
+    /**
+     * Returns all the metrics, one per line, with the hit rate of the caches.
+     * @return The text to dump.
+     */
+    static QString toString();
+
+private:
+
+    /// Name of each counter.
+    static const char *COUNTER_NAMES[NUM_COUNTERS];
+
+    /// Name and unit of each histogram.
+    static const char *HISTOGRAM_NAMES[NUM_DISTRIBUTIONS][2];
+
+    /// Name of each subsystem.
+    static const char *SUBSYSTEM_NAMES[NUM_SUBSYSTEMS];
+
+    /// Value of each counter.
+    static QAtomicInt counters[NUM_COUNTERS];
+
+    /// Samples of each histogram.
+    static Histogram histograms[NUM_DISTRIBUTIONS];
+
+    /// Live objects of each subsystem.
+    static QAtomicInt objects[NUM_SUBSYSTEMS];
+
+    /// Bytes held by each subsystem.
+    static QAtomicInt bytes[NUM_SUBSYSTEMS];
+
+};
+
+#endif // METRICS_METRICS_H
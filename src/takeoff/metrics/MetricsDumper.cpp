@@ -0,0 +1,85 @@
+/**
+ * @file /src/takeoff/metrics/MetricsDumper.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  MetricsDumper
+ */
+#include "MetricsDumper.h"
+#include <QtDBus/QDBusConnection>
+#include <KDE/KDebug>
+#include <KDE/KSaveFile>
+#include <KDE/KStandardDirs>
+#include "Metrics.h"
+
+// ************************************************************************** //
+// **********             STATIC METHODS AND VARIABLES             ********** //
+// ************************************************************************** //
+
+const char *MetricsDumper::DBUS_PATH = "/Takeoff/Metrics";
+
+MetricsDumper *MetricsDumper::instance = NULL;
+
+MetricsDumper *MetricsDumper::getInstance()
+{
+    if (MetricsDumper::instance == NULL)
+        MetricsDumper::instance = new MetricsDumper();
+
+    return MetricsDumper::instance;
+}
+
+QString MetricsDumper::getDumpPath()
+{
+    return KStandardDirs::locateLocal("cache", "takeoff/metrics.txt", true);
+}
+
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+MetricsDumper::MetricsDumper()
+        : QObject()
+{
+    if (!QDBusConnection::sessionBus().registerObject(DBUS_PATH, this,
+            QDBusConnection::ExportScriptableSlots))
+        kDebug() << "The metrics are only dumped from the context menu,"
+                << DBUS_PATH << "is already registered";
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC SLOTS                      ********** //
+// ************************************************************************** //
+
+QString MetricsDumper::dump()
+{
+    QString path = getDumpPath();
+    QByteArray data = Metrics::toString().toUtf8();
+
+    KSaveFile file(path);
+    if (!file.open() || file.write(data) != data.size()) {
+        file.abort();
+        kDebug() << "Error writing the metrics to" << path;
+        return QString();
+    }
+    if (!file.finalize())
+        return QString();
+
+    kDebug() << "Metrics written to" << path;
+    return path;
+}
+
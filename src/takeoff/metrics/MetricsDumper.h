@@ -0,0 +1,78 @@
+/**
+ * @file /src/takeoff/metrics/MetricsDumper.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  MetricsDumper
+ */
+#ifndef METRICS_METRICSDUMPER_H
+#define METRICS_METRICSDUMPER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+/**
+ * Writes the Metrics to a file in the cache directory, when it is asked from
+ * the context menu or through D-Bus:
+ *
+ *     qdbus org.kde.plasma-desktop /Takeoff/Metrics dump
+ *
+ * Takeoff runs inside plasma-desktop, so it doesn't install signal handlers
+ * to be triggered from outside.
+ */
+class MetricsDumper : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.takeoff.Metrics")
+
+public:
+
+    /**
+     * Only method to get an instance of the class. The object is registered in
+     * the session bus the first time.
+     * @return The single instance of the class.
+     */
+    static MetricsDumper *getInstance();
+
+public slots:
+
+    /**
+     * Writes the metrics.
+     * @return The path of the written file or an empty string on error.
+     */
+    Q_SCRIPTABLE QString dump();
+
+private:
+
+    /// Path of the object in the session bus.
+    static const char *DBUS_PATH;
+
+    /// Returns the path of the file to write.
+    static QString getDumpPath();
+
+    //--------------------------------------------------------------------------
+
+    /// Single instance of the class.
+    static MetricsDumper *instance;
+
+    // Hide constructors
+    MetricsDumper();
+    MetricsDumper(const MetricsDumper&);
+    const MetricsDumper &operator = (const MetricsDumper&);
+
+};
+
+#endif // METRICS_METRICSDUMPER_H
@@ -26,6 +26,7 @@
 #include <QtGui/QDesktopWidget>
 #include <KDE/KStandardDirs>
 #include <KDE/KIcon>
+#include "../../trace/Trace.h"
 
 // ************************************************************************** //
 // **********             STATIC METHODS AND VARIABLES             ********** //
@@ -41,18 +42,26 @@ Config *Config::getInstance()
     return Config::instance;
 }
 
-void Config::loadConfig()
+Config::Fields Config::loadConfig()
 {
-    if (instance != NULL) {
-        delete instance;
-        instance = NULL;
+    // The first call already reads the values
+    if (instance == NULL) {
+        Config::getInstance();
+        return Fields();
     }
-    Config::getInstance();
+
+    instance->settings->sync();
+    Values newValues = instance->readValues();
+    Fields fields = diff(instance->values, newValues);
+    instance->values = newValues;
+
+    return fields;
 }
 
 const char *Config::SHOW_FAVORITES        = "Takeoff/ShowFavorites";
 const char *Config::SHOW_ALL_APPLICATIONS = "Takeoff/ShowAllApplications";
 const char *Config::SHOW_XDG_MENU         = "Takeoff/ShowXdgMenu";
+const char *Config::SHOW_MOST_USED        = "Takeoff/ShowMostUsed";
 const char *Config::LAUNCHER_SIZE         = "Takeoff/LauncherSize";
 const char *Config::SEPARATION_BETWEEN_LAUNCHERS
         = "Takeoff/SeparationBetweenLaunchers";
@@ -60,6 +69,11 @@ const char *Config::NUM_ROWS              = "Takeoff/NumRows";
 const char *Config::NUM_COLUMNS           = "Takeoff/NumColumns";
 const char *Config::ICON                  = "Takeoff/Icon";
 const char *Config::REMEMBER_LAST_TAB     = "Takeoff/RememberLastTab";
+const char *Config::PREWARM_TABS          = "Takeoff/PrewarmTabs";
+const char *Config::PREWARM_ON_HOVER      = "Takeoff/PrewarmOnHover";
+const char *Config::SINGLE_PAINTER_GRID   = "Takeoff/SinglePainterGrid";
+const char *Config::PREFETCH_APPLICATIONS = "Takeoff/PrefetchApplications";
+const char *Config::MENU_BACKEND          = "Takeoff/MenuBackend";
 const char *Config::SHOW_ICON_TEXT        = "Takeoff/ShowIconText";
 const char *Config::FULL_SCREEN           = "Takeoff/FullScreen";
 const char *Config::SHOW_BACKGROUND_IMAGE = "Takeoff/ShowBackgroundImage";
@@ -71,7 +85,21 @@ const char *Config::BACKGROUND_IMAGE      = "Takeoff/BackgroundImage";
 // ************************************************************************** //
 
 Config::Config()
+        : settings(new QSettings(this->getConfigFilePath(), QSettings::IniFormat,
+                  this))
+{
+    this->values = this->readValues();
+}
+
+
+// ************************************************************************** //
+// **********                   PRIVATE METHODS                    ********** //
+// ************************************************************************** //
+
+Config::Values Config::readValues()
 {
+    TAKEOFF_TRACE_SPAN("Config::readValues");
+
     // Get the distro icon if is available, else put the default icon
     QString icon = KIcon("start-here-branding").isNull()
             ? "start-here-kde"
@@ -91,36 +119,90 @@ Config::Config()
     if (numColumns <= 3)  numColumns = 3;
     if (numColumns >= 20) numColumns = 20;
 
-    // Load the configuration into the QHash
-    this->settings = new QSettings(this->getConfigFilePath(),
-            QSettings::IniFormat, this);
-
-    this->loadProperty(SHOW_FAVORITES, true);
-    this->loadProperty(SHOW_ALL_APPLICATIONS, true);
-    this->loadProperty(SHOW_XDG_MENU, true);
-    this->loadProperty(LAUNCHER_SIZE, launcherSize);
-    this->loadProperty(SEPARATION_BETWEEN_LAUNCHERS, launcherSeparation);
-    this->loadProperty(NUM_ROWS, numRows);
-    this->loadProperty(NUM_COLUMNS, numColumns);
-    this->loadProperty(ICON, icon);
-    this->loadProperty(REMEMBER_LAST_TAB, false);
-    this->loadProperty(SHOW_ICON_TEXT, true);
-    this->loadProperty(FULL_SCREEN, true);
-    this->loadProperty(SHOW_BACKGROUND_IMAGE, false);
-    this->loadProperty(BACKGROUND_IMAGE, "");
+    // Load the configuration into the QHash and the typed values
+    Values v;
+    v.showFavorites = this->loadProperty(SHOW_FAVORITES, true).toBool();
+    v.showAllApplications =
+            this->loadProperty(SHOW_ALL_APPLICATIONS, true).toBool();
+    v.showXdgMenu = this->loadProperty(SHOW_XDG_MENU, true).toBool();
+    v.showMostUsed = this->loadProperty(SHOW_MOST_USED, false).toBool();
+    v.launcherSize = this->loadProperty(LAUNCHER_SIZE, launcherSize).toInt();
+    v.separationBetweenLaunchers = this->loadProperty(
+            SEPARATION_BETWEEN_LAUNCHERS, launcherSeparation).toInt();
+    v.numRows = this->loadProperty(NUM_ROWS, numRows).toInt();
+    v.numColumns = this->loadProperty(NUM_COLUMNS, numColumns).toInt();
+    v.icon = this->loadProperty(ICON, icon).toString();
+    v.rememberLastTab = this->loadProperty(REMEMBER_LAST_TAB, false).toBool();
+    v.prewarmTabs = this->loadProperty(PREWARM_TABS, true).toBool();
+    v.prewarmOnHover = this->loadProperty(PREWARM_ON_HOVER, true).toBool();
+    v.singlePainterGrid =
+            this->loadProperty(SINGLE_PAINTER_GRID, false).toBool();
+    v.prefetchApplications =
+            this->loadProperty(PREFETCH_APPLICATIONS, false).toBool();
+    v.menuBackend = this->loadProperty(MENU_BACKEND, 0).toInt();
+    v.showIconText = this->loadProperty(SHOW_ICON_TEXT, true).toBool();
+    v.fullScreen = this->loadProperty(FULL_SCREEN, true).toBool();
+    v.showBackgroundImage =
+            this->loadProperty(SHOW_BACKGROUND_IMAGE, false).toBool();
+    v.backgroundImage = this->loadProperty(BACKGROUND_IMAGE, "").toString();
+
+    return v;
 }
 
+Config::Fields Config::diff(const Values &a, const Values &b)
+{
+    Fields ret;
+    if (a.showFavorites != b.showFavorites)
+        ret |= SHOW_FAVORITES_FIELD;
+    if (a.showAllApplications != b.showAllApplications)
+        ret |= SHOW_ALL_APPLICATIONS_FIELD;
+    if (a.showXdgMenu != b.showXdgMenu)
+        ret |= SHOW_XDG_MENU_FIELD;
+    if (a.showMostUsed != b.showMostUsed)
+        ret |= SHOW_MOST_USED_FIELD;
+    if (a.launcherSize != b.launcherSize)
+        ret |= LAUNCHER_SIZE_FIELD;
+    if (a.separationBetweenLaunchers != b.separationBetweenLaunchers)
+        ret |= SEPARATION_BETWEEN_LAUNCHERS_FIELD;
+    if (a.numRows != b.numRows)
+        ret |= NUM_ROWS_FIELD;
+    if (a.numColumns != b.numColumns)
+        ret |= NUM_COLUMNS_FIELD;
+    if (a.icon != b.icon)
+        ret |= ICON_FIELD;
+    if (a.rememberLastTab != b.rememberLastTab)
+        ret |= REMEMBER_LAST_TAB_FIELD;
+    if (a.prewarmTabs != b.prewarmTabs)
+        ret |= PREWARM_TABS_FIELD;
+    if (a.prewarmOnHover != b.prewarmOnHover)
+        ret |= PREWARM_ON_HOVER_FIELD;
+    if (a.singlePainterGrid != b.singlePainterGrid)
+        ret |= SINGLE_PAINTER_GRID_FIELD;
+    if (a.prefetchApplications != b.prefetchApplications)
+        ret |= PREFETCH_APPLICATIONS_FIELD;
+    if (a.menuBackend != b.menuBackend)
+        ret |= MENU_BACKEND_FIELD;
+    if (a.showIconText != b.showIconText)
+        ret |= SHOW_ICON_TEXT_FIELD;
+    if (a.fullScreen != b.fullScreen)
+        ret |= FULL_SCREEN_FIELD;
+    if (a.showBackgroundImage != b.showBackgroundImage)
+        ret |= SHOW_BACKGROUND_IMAGE_FIELD;
+    if (a.backgroundImage != b.backgroundImage)
+        ret |= BACKGROUND_IMAGE_FIELD;
+
+    return ret;
+}
 
-// ************************************************************************** //
-// **********                   PRIVATE METHODS                    ********** //
-// ************************************************************************** //
-
-void Config::loadProperty(const char *property, const QVariant &defaultValue)
+QVariant Config::loadProperty(const char *property,
+        const QVariant &defaultValue)
 {
     if (!this->settings->contains(property))
         this->settings->setValue(property, defaultValue);
 
-    this->hashSettings.insert(property, this->settings->value(property));
+    QVariant value = this->settings->value(property);
+    this->hashSettings.insert(property, value);
+    return value;
 }
 
 
@@ -128,6 +210,11 @@ void Config::loadProperty(const char *property, const QVariant &defaultValue)
 // **********                      GET/SET/IS                      ********** //
 // ************************************************************************** //
 
+const Config::Values &Config::getValues() const
+{
+    return this->values;
+}
+
 QVariant Config::getSettings(const char *propertyName) const
 {
     return this->hashSettings.value(propertyName);
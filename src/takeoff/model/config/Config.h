@@ -23,16 +23,69 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QHash>
+#include <QtCore/QString>
 class QSettings;
 
 /**
- * Singleton that provides access to the configuration.
+ * Singleton that provides access to the configuration. The values are read
+ * into a typed Config::Values when the configuration is loaded.
  */
 class Config : public QObject
 {
 
 public:
 
+    /**
+     * Typed copy of the configuration.
+     */
+    struct Values {
+        bool    showFavorites;
+        bool    showAllApplications;
+        bool    showXdgMenu;
+        bool    showMostUsed;
+        int     launcherSize;
+        int     separationBetweenLaunchers;
+        int     numRows;
+        int     numColumns;
+        QString icon;
+        bool    rememberLastTab;
+        bool    prewarmTabs;
+        bool    prewarmOnHover;
+        bool    singlePainterGrid;
+        bool    prefetchApplications;
+        int     menuBackend;
+        bool    showIconText;
+        bool    fullScreen;
+        bool    showBackgroundImage;
+        QString backgroundImage;
+    };
+
+    /**
+     * Fields of Config::Values, to indicate which ones have changed.
+     */
+    enum Field {
+        SHOW_FAVORITES_FIELD               = 0x0001,
+        SHOW_ALL_APPLICATIONS_FIELD        = 0x0002,
+        SHOW_XDG_MENU_FIELD                = 0x0004,
+        SHOW_MOST_USED_FIELD               = 0x0008,
+        LAUNCHER_SIZE_FIELD                = 0x0010,
+        SEPARATION_BETWEEN_LAUNCHERS_FIELD = 0x0020,
+        NUM_ROWS_FIELD                     = 0x0040,
+        NUM_COLUMNS_FIELD                  = 0x0080,
+        ICON_FIELD                         = 0x0100,
+        REMEMBER_LAST_TAB_FIELD            = 0x0200,
+        SHOW_ICON_TEXT_FIELD               = 0x0400,
+        FULL_SCREEN_FIELD                  = 0x0800,
+        SHOW_BACKGROUND_IMAGE_FIELD        = 0x1000,
+        BACKGROUND_IMAGE_FIELD             = 0x2000,
+        PREWARM_TABS_FIELD                 = 0x4000,
+        PREWARM_ON_HOVER_FIELD             = 0x8000,
+        SINGLE_PAINTER_GRID_FIELD          = 0x10000,
+        PREFETCH_APPLICATIONS_FIELD        = 0x20000,
+        MENU_BACKEND_FIELD                 = 0x40000
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+
     /**
      * Only method to get an instance of the class.
      * @return The single instance of the class.
@@ -40,9 +93,10 @@ public:
     static Config* getInstance();
 
     /**
-     * (Re)Loads the configuration.
+     * Reloads the configuration.
+     * @return The changed fields, so the caller updates only what they affect.
      */
-    static void loadConfig();
+    static Fields loadConfig();
 
     //--------------------------------------------------------------------------
 
@@ -50,17 +104,30 @@ public:
     static const char *SHOW_FAVORITES;
     static const char *SHOW_ALL_APPLICATIONS;
     static const char *SHOW_XDG_MENU;
+    static const char *SHOW_MOST_USED;
     static const char *LAUNCHER_SIZE;
     static const char *SEPARATION_BETWEEN_LAUNCHERS;
     static const char *NUM_ROWS;
     static const char *NUM_COLUMNS;
     static const char *ICON;
     static const char *REMEMBER_LAST_TAB;
+    static const char *PREWARM_TABS;
+    static const char *PREWARM_ON_HOVER;
+    static const char *SINGLE_PAINTER_GRID;
+    static const char *PREFETCH_APPLICATIONS;
+    static const char *MENU_BACKEND;
     static const char *SHOW_ICON_TEXT;
     static const char *FULL_SCREEN;
     static const char *SHOW_BACKGROUND_IMAGE;
     static const char *BACKGROUND_IMAGE;
 
+    /**
+     * Returns the current values. They change when loadConfig() is called, so
+     * copy them to keep the old ones.
+     * @return The values.
+     */
+    const Values &getValues() const;
+
     /**
      * Returns the specified property.
      * @param  propertyName The property to get.
@@ -83,12 +150,27 @@ public:
 
 private:
 
+    /**
+     * Reads the values from the settings.
+     * @return The values.
+     */
+    Values readValues();
+
+    /**
+     * Compares two sets of values.
+     * @param  a The old values.
+     * @param  b The new values.
+     * @return The fields that are different.
+     */
+    static Fields diff(const Values &a, const Values &b);
+
     /**
      * Load the specified property. If is not available, puts the default value.
-     * @param property The property to load. Is one of the Config::Property.
-     * @param defaultValue The value to set if the property doesn't exist.
+     * @param  property The property to load. Is one of the Config::Property.
+     * @param  defaultValue The value to set if the property doesn't exist.
+     * @return The value of the property.
      */
-    void loadProperty(const char *property, const QVariant &defaultValue);
+    QVariant loadProperty(const char *property, const QVariant &defaultValue);
 
     //--------------------------------------------------------------------------
 
@@ -98,6 +180,9 @@ private:
     /// Hash with the configuration
     QHash<QString, QVariant> hashSettings;
 
+    /// Current values.
+    Values values;
+
     /// Single instance of the class.
     static Config* instance;
 
@@ -107,4 +192,6 @@ private:
     const Config &operator = (const Config&);
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(Config::Fields)
+
 #endif // CONFIG_CONFIG_H
@@ -42,6 +42,8 @@ ConfigForm::ConfigForm(QWidget *parent)
             this->cfg->getSettings(Config::SHOW_ALL_APPLICATIONS).toBool());
     this->ui->showXdgMenu->setChecked(
             this->cfg->getSettings(Config::SHOW_XDG_MENU).toBool());
+    this->ui->showMostUsed->setChecked(
+            this->cfg->getSettings(Config::SHOW_MOST_USED).toBool());
     this->ui->launcherSize->setValue(
             this->cfg->getSettings(Config::LAUNCHER_SIZE).toInt());
     this->ui->separationSize->setValue(this->cfg->getSettings(
@@ -54,6 +56,16 @@ ConfigForm::ConfigForm(QWidget *parent)
             KIcon(this->cfg->getSettings(Config::ICON).toString()));
     this->ui->rememberLastTab->setChecked(
             this->cfg->getSettings(Config::REMEMBER_LAST_TAB).toBool());
+    this->ui->prewarmTabs->setChecked(
+            this->cfg->getSettings(Config::PREWARM_TABS).toBool());
+    this->ui->prewarmOnHover->setChecked(
+            this->cfg->getSettings(Config::PREWARM_ON_HOVER).toBool());
+    this->ui->singlePainterGrid->setChecked(
+            this->cfg->getSettings(Config::SINGLE_PAINTER_GRID).toBool());
+    this->ui->prefetchApplications->setChecked(
+            this->cfg->getSettings(Config::PREFETCH_APPLICATIONS).toBool());
+    this->ui->menuBackend->setCurrentIndex(
+            this->cfg->getSettings(Config::MENU_BACKEND).toInt());
     this->ui->showIconText->setChecked(
             this->cfg->getSettings(Config::SHOW_ICON_TEXT).toBool());
     this->ui->fullScreen->setChecked(
@@ -98,6 +110,12 @@ void ConfigForm::on_showXdgMenu_clicked()
             this->ui->showXdgMenu->isChecked());
 }
 
+void ConfigForm::on_showMostUsed_clicked()
+{
+    this->cfg->setSettings(Config::SHOW_MOST_USED,
+            this->ui->showMostUsed->isChecked());
+}
+
 void ConfigForm::on_launcherSize_valueChanged(int value)
 {
     this->cfg->setSettings(Config::LAUNCHER_SIZE, value);
@@ -134,6 +152,36 @@ void ConfigForm::on_rememberLastTab_clicked()
             this->ui->rememberLastTab->isChecked());
 }
 
+void ConfigForm::on_prewarmTabs_clicked()
+{
+    this->cfg->setSettings(Config::PREWARM_TABS,
+            this->ui->prewarmTabs->isChecked());
+}
+
+void ConfigForm::on_prewarmOnHover_clicked()
+{
+    this->cfg->setSettings(Config::PREWARM_ON_HOVER,
+            this->ui->prewarmOnHover->isChecked());
+}
+
+void ConfigForm::on_singlePainterGrid_clicked()
+{
+    this->cfg->setSettings(Config::SINGLE_PAINTER_GRID,
+            this->ui->singlePainterGrid->isChecked());
+}
+
+void ConfigForm::on_prefetchApplications_clicked()
+{
+    this->cfg->setSettings(Config::PREFETCH_APPLICATIONS,
+            this->ui->prefetchApplications->isChecked());
+}
+
+void ConfigForm::on_menuBackend_currentIndexChanged(int index)
+{
+    // The items are in the same order as MenuBackend::Type
+    this->cfg->setSettings(Config::MENU_BACKEND, index);
+}
+
 void ConfigForm::on_showIconText_clicked()
 {
     this->cfg->setSettings(Config::SHOW_ICON_TEXT,
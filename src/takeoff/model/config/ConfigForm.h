@@ -46,6 +46,8 @@ private slots:
 
     void on_showXdgMenu_clicked();
 
+    void on_showMostUsed_clicked();
+
     void on_launcherSize_valueChanged(int value);
 
     void on_separationSize_valueChanged(int value);
@@ -58,6 +60,16 @@ private slots:
 
     void on_rememberLastTab_clicked();
 
+    void on_prewarmTabs_clicked();
+
+    void on_prewarmOnHover_clicked();
+
+    void on_singlePainterGrid_clicked();
+
+    void on_prefetchApplications_clicked();
+
+    void on_menuBackend_currentIndexChanged(int index);
+
     void on_showIconText_clicked();
 
     void on_fullScreen_clicked();
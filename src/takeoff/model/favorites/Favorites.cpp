@@ -19,12 +19,59 @@
  * @class  Favorites
  */
 #include "Favorites.h"
+#include <QtCore/QCoreApplication>
 #include <QtCore/QFile>
-#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QRunnable>
 #include <QtCore/QSettings>
-#include <QtCore/QLocale>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
+#include <KDE/KDirWatch>
 #include <KDE/KIcon>
+#include <KDE/KSaveFile>
 #include <KDE/KStandardDirs>
+#include "../menu/Menu.h"
+#include "../menu/qtxdg/xdgdesktopfile.h"
+
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/// Milliseconds to wait for more changes before writing the favorites.
+const int SAVE_DELAY = 500;
+
+/**
+ * Replaces the favorites file atomically.
+ */
+class SaveJob : public QRunnable
+{
+public:
+    SaveJob(const QString &path, const QByteArray &data)
+            : path(path),
+              data(data)
+    {
+
+    }
+
+    virtual void run()
+    {
+        KSaveFile file(this->path);
+        if (!file.open() || file.write(this->data) != this->data.size()) {
+            file.abort();
+            return;
+        }
+        file.finalize();
+    }
+
+private:
+    QString path;
+    QByteArray data;
+};
+
+}
+
 
 // ************************************************************************** //
 // **********             STATIC METHODS AND VARIABLES             ********** //
@@ -34,76 +81,210 @@ Favorites *Favorites::instance = NULL;
 
 Favorites *Favorites::getInstance()
 {
-    if (Favorites::instance == NULL)
+    if (Favorites::instance == NULL) {
         Favorites::instance = new Favorites();
+        Favorites::instance->load();
+    }
 
     return Favorites::instance;
 }
 
+QString Favorites::getFilePath()
+{
+    return KStandardDirs::locateLocal("config", "takeoff/favorites", true);
+}
+
+QByteArray Favorites::readFile(bool *ok)
+{
+    QFile file(getFilePath());
+    *ok = file.open(QIODevice::ReadOnly);
+    return *ok ? file.readAll() : QByteArray();
+}
+
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+Favorites::Favorites()
+        : QObject(),
+          saveTimer(new QTimer(this)),
+          writer(new QThreadPool(this))
+{
+    this->writer->setMaxThreadCount(1);
+    this->saveTimer->setSingleShot(true);
+    this->saveTimer->setInterval(SAVE_DELAY);
+    connect(this->saveTimer, SIGNAL(timeout()), this, SLOT(save()));
+
+    // The changes of the last SAVE_DELAY would be lost otherwise
+    connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()),
+            this, SLOT(flush()));
+
+    KDirWatch *watch = KDirWatch::self();
+    watch->addFile(getFilePath());
+    connect(watch, SIGNAL(dirty(QString)), this, SLOT(fileChanged(QString)));
+    connect(watch, SIGNAL(created(QString)), this, SLOT(fileChanged(QString)));
+}
+
 
 // ************************************************************************** //
 // **********                    PUBLIC METHODS                    ********** //
 // ************************************************************************** //
 
-QList<Takeoff::Launcher*> Favorites::getFavorites()
+QList<Takeoff::LauncherData> Favorites::getFavorites()
 {
-    QString favoritesFile = KStandardDirs::locate("config", "takeoffrc");
-    QSettings settings(favoritesFile, QSettings::IniFormat);
-    settings.setIniCodec("UTF-8");
-    QStringList desktopFiles =
-            settings.value("Favorites/FavoriteURLs").toStringList();
-
-    QList<Takeoff::Launcher*> ret;
-    foreach (const QString &file, desktopFiles) {
-        QSettings desktop(file, QSettings::IniFormat);
-        desktop.setIniCodec("UTF-8");
-
-        // Name of the application (with internatilatization)
-        QString completeLocale = QLocale::system().name(); // For example es_ES
-        QString simpleLocale   = completeLocale.split("_").at(0); // and es
-
-        QString appName = desktop.value(
-                "Desktop Entry/Name[" + completeLocale + "]", "").toString();
-        if (appName.isEmpty())
-            appName = desktop.value(
-                    "Desktop Entry/Name[" + simpleLocale + "]", "").toString();
-        if (appName.isEmpty())
-            appName = desktop.value("Desktop Entry/Name").toString();
-
-        // Create the launcher and it to the list
-        Takeoff::Launcher *launcher = new Takeoff::Launcher(KIcon(
-                desktop.value("Desktop Entry/Icon").toString()), appName, file);
-        ret.append(launcher);
-    }
+    QList<Takeoff::LauncherData> ret;
+    for (int n=0; n<this->desktopFiles.length(); n++)
+        ret.append(this->getFavorite(n));
 
     return ret;
 }
 
+Takeoff::LauncherData Favorites::getFavorite(int index) const
+{
+    QString file = this->desktopFiles.at(index);
+
+    Menu *menu = Menu::getInstance();
+    int menuIndex = menu->getApplicationIndex(file);
+    XdgDesktopFile *desktop = (menuIndex == -1)
+            ? XdgDesktopFileCache::getFile(file) : NULL;
+
+    Takeoff::LauncherData launcher;
+    if (menuIndex != -1) {
+        launcher = menu->getAllApplications()->at(menuIndex)->getData();
+    } else if (desktop != NULL && desktop->isValid()) {
+        // Applications that are not in the menu
+        launcher = Takeoff::LauncherData(desktop->icon(), desktop->name(),
+                file);
+    } else {
+        // Keep a launcher for the missing applications so the positions of
+        // the launchers match the positions of the favorites
+        launcher = Takeoff::LauncherData(KIcon("application-x-desktop"),
+                QFileInfo(file).completeBaseName(), file);
+    }
+
+    // The favorites are accounted apart to find the leaked ones
+    launcher.subsystem = Metrics::FAVORITES;
+    return launcher;
+}
+
 void Favorites::addToFavorites(const Takeoff::Launcher *launcher)
 {
-    QString favoritesFile = KStandardDirs::locate("config", "takeoffrc");
-    QSettings settings(favoritesFile, QSettings::IniFormat);
-    QStringList desktopFiles =
-            settings.value("Favorites/FavoriteURLs").toStringList();
-    desktopFiles.append(launcher->getDesktopFile());
-    settings.setValue("Favorites/FavoriteURLs", desktopFiles);
+    QString file = launcher->getDesktopFile();
+    if (this->desktopFilesSet.contains(file))
+        return;
+
+    this->desktopFiles.append(file);
+    this->desktopFilesSet.insert(file);
+    this->saveTimer->start();
+    emit this->added(this->desktopFiles.length()-1);
 }
 
 void Favorites::removeFromFavorites(const Takeoff::Launcher *launcher)
 {
-    QString favoritesFile = KStandardDirs::locate("config", "takeoffrc");
-    QSettings settings(favoritesFile, QSettings::IniFormat);
-    QStringList desktopFiles =
-            settings.value("Favorites/FavoriteURLs").toStringList();
-    desktopFiles.removeAll(launcher->getDesktopFile());
-    settings.setValue("Favorites/FavoriteURLs", desktopFiles);
+    QString file = launcher->getDesktopFile();
+    if (!this->desktopFilesSet.remove(file))
+        return;
+
+    int index = this->desktopFiles.indexOf(file);
+    this->desktopFiles.removeAt(index);
+    this->saveTimer->start();
+    emit this->removed(index);
 }
 
 bool Favorites::isfavorite(const Takeoff::Launcher *launcher)
 {
-    QString favoritesFile = KStandardDirs::locate("config", "takeoffrc");
-    QSettings settings(favoritesFile, QSettings::IniFormat);
-    QStringList desktopFiles =
-            settings.value("Favorites/FavoriteURLs").toStringList();
-    return desktopFiles.contains(launcher->getDesktopFile());
+    return this->desktopFilesSet.contains(launcher->getDesktopFile());
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC SLOTS                      ********** //
+// ************************************************************************** //
+
+void Favorites::flush()
+{
+    if (this->saveTimer->isActive()) {
+        this->saveTimer->stop();
+        this->save();
+    }
+
+    this->writer->waitForDone();
+}
+
+
+// ************************************************************************** //
+// **********                    PRIVATE SLOTS                     ********** //
+// ************************************************************************** //
+
+void Favorites::save()
+{
+    QByteArray data;
+    foreach (const QString &file, this->desktopFiles)
+        data.append(file.toUtf8()).append('\n');
+
+    this->pendingWrites.append(data);
+    this->writer->start(new SaveJob(getFilePath(), data));
+}
+
+void Favorites::fileChanged(const QString &path)
+{
+    if (path != getFilePath())
+        return;
+
+    // The unsaved changes will overwrite the file anyway
+    if (this->saveTimer->isActive())
+        return;
+
+    bool ok;
+    QByteArray data = readFile(&ok);
+
+    // Ignore the notifications of our own writes
+    int pending = this->pendingWrites.indexOf(data);
+    if (pending != -1) {
+        this->pendingWrites = this->pendingWrites.mid(pending + 1);
+        return;
+    }
+
+    QStringList old = this->desktopFiles;
+    this->load();
+    if (this->desktopFiles != old)
+        emit this->changed();
+}
+
+
+// ************************************************************************** //
+// **********                   PRIVATE METHODS                    ********** //
+// ************************************************************************** //
+
+void Favorites::load()
+{
+    this->desktopFiles.clear();
+    this->desktopFilesSet.clear();
+
+    bool ok;
+    QByteArray data = readFile(&ok);
+    QStringList files;
+
+    if (ok) {
+        foreach (const QByteArray &line, data.split('\n')) {
+            if (!line.isEmpty())
+                files.append(QString::fromUtf8(line));
+        }
+    } else {
+        // Favorites of the previous versions, saved in the takeoffrc
+        QString favoritesFile = KStandardDirs::locate("config", "takeoffrc");
+        QSettings settings(favoritesFile, QSettings::IniFormat);
+        settings.setIniCodec("UTF-8");
+        files = settings.value("Favorites/FavoriteURLs").toStringList();
+        if (!files.isEmpty())
+            this->saveTimer->start();
+    }
+
+    foreach (const QString &file, files) {
+        if (!this->desktopFilesSet.contains(file)) {
+            this->desktopFiles.append(file);
+            this->desktopFilesSet.insert(file);
+        }
+    }
 }
@@ -21,19 +21,31 @@
 #ifndef MODEL_FAVORITES_H
 #define MODEL_FAVORITES_H
 
+#include <QtCore/QByteArray>
 #include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QSet>
+#include <QtCore/QStringList>
 #include "../../takeoff_widget/Launcher.h"
+class QThreadPool;
+class QTimer;
 
 /**
- * Class to access to the Kickoff favorites.
+ * Class to access to the favorite applications. The favorites are loaded once
+ * and kept in memory, the changes are written a bit later in other thread, so
+ * several changes are saved together. The file is watched to reload it when it
+ * is edited from outside. The pending changes are written before the
+ * application quits.
  */
-class Favorites
+class Favorites : public QObject
 {
+    Q_OBJECT
 
 public:
 
     /**
-     * Only method to get an instance of the class.
+     * Only method to get an instance of the class. The favorites are loaded the
+     * first time.
      * @return The single instance of the class.
      */
     static Favorites *getInstance();
@@ -41,10 +53,19 @@ public:
     //--------------------------------------------------------------------------
 
     /**
-     * Returns the list of the favorite applications
+     * Returns the list of the favorite applications. The names and icons are
+     * taken from the menu or, if the application is not in the menu, from its
+     * desktop file.
      * @return The list.
      */
-    QList<Takeoff::Launcher*> getFavorites();
+    QList<Takeoff::LauncherData> getFavorites();
+
+    /**
+     * Returns the launcher of the specified favorite.
+     * @param  index The position of the favorite.
+     * @return The data of the launcher.
+     */
+    Takeoff::LauncherData getFavorite(int index) const;
 
     /**
      * Adds the specified launcher to favorites.
@@ -65,13 +86,81 @@ public:
      */
     bool isfavorite(const Takeoff::Launcher *launcher);
 
+signals:
+
+    /**
+     * Signal that is emitted when a favorite is added.
+     * @param index The position of the new favorite.
+     */
+    void added(int index);
+
+    /**
+     * Signal that is emitted when a favorite is removed.
+     * @param index The position the favorite had.
+     */
+    void removed(int index);
+
+    /**
+     * Signal that is emitted when the favorites file is changed from outside.
+     */
+    void changed();
+
+public slots:
+
+    /**
+     * Writes the pending changes and waits until the file is written. Called
+     * when the application is about to quit.
+     */
+    void flush();
+
+private slots:
+
+    /// Writes the favorites in the writer thread.
+    void save();
+
+    /**
+     * Reloads the favorites if the file was changed from outside.
+     * @param path The changed file.
+     */
+    void fileChanged(const QString &path);
+
 private:
 
+    /// Reads the favorites file, or the old takeoffrc entry if it is missing.
+    void load();
+
+    /**
+     * Reads the favorites file.
+     * @param  ok Set to false if the file doesn't exist.
+     * @return The content of the file.
+     */
+    static QByteArray readFile(bool *ok);
+
+    /// Returns the path of the favorites file.
+    static QString getFilePath();
+
+    //--------------------------------------------------------------------------
+
+    /// Desktop files of the favorite applications, in order.
+    QStringList desktopFiles;
+
+    /// The same desktop files, to check if an application is a favorite.
+    QSet<QString> desktopFilesSet;
+
+    /// Contents sent to the writer thread, to ignore them when the file changes.
+    QList<QByteArray> pendingWrites;
+
+    /// Delays the writes to save several changes together.
+    QTimer *saveTimer;
+
+    /// Thread where the file is written, one job at a time.
+    QThreadPool *writer;
+
     /// Single instance of the class.
     static Favorites* instance;
 
     // Hide constructors
-    Favorites(){}
+    Favorites();
     Favorites(const Favorites&);
     const Favorites &operator = (const Favorites&);
 
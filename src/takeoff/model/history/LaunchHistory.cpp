@@ -0,0 +1,331 @@
+/**
+ * @file /src/takeoff/model/history/LaunchHistory.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  LaunchHistory
+ */
+#include "LaunchHistory.h"
+#include <math.h>
+#include <QtCore/QByteArray>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+#include <KDE/KSaveFile>
+#include <KDE/KStandardDirs>
+
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/**
+ * Appends a launch to the end of the history file.
+ */
+class AppendJob : public QRunnable
+{
+public:
+    AppendJob(const QString &tablePath, const QByteArray &record)
+            : tablePath(tablePath),
+              record(record)
+    {
+
+    }
+
+    virtual void run()
+    {
+        QFile table(this->tablePath);
+        if (table.open(QIODevice::WriteOnly | QIODevice::Append))
+            table.write(this->record);
+    }
+
+private:
+    QString tablePath;
+    QByteArray record;
+};
+
+/**
+ * Writes the table with all the launches, replacing the appended ones.
+ */
+class CompactJob : public QRunnable
+{
+public:
+    CompactJob(const QString &tablePath,
+            const QHash<QString, LaunchHistory::Entry> &entries, quint32 epoch,
+            quint32 version)
+            : tablePath(tablePath),
+              entries(entries),
+              epoch(epoch),
+              version(version)
+    {
+
+    }
+
+    virtual void run()
+    {
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out << this->version << this->epoch << quint32(this->entries.size());
+
+        QHashIterator<QString, LaunchHistory::Entry> it(this->entries);
+        while (it.hasNext()) {
+            it.next();
+            out << it.key() << it.value().weight << it.value().count
+                    << it.value().lastLaunch;
+        }
+
+        // Replace the file atomically, a crash never leaves half a table. The
+        // appended launches are in the table now
+        KSaveFile table(this->tablePath);
+        if (!table.open() || table.write(data) != data.size()) {
+            table.abort();
+            return;
+        }
+        table.finalize();
+    }
+
+private:
+    QString tablePath;
+    QHash<QString, LaunchHistory::Entry> entries;
+    quint32 epoch;
+    quint32 version;
+};
+
+/// Sorts the applications by weight, the highest first.
+bool moreUsed(const QPair<double, QString> &a, const QPair<double, QString> &b)
+{
+    return a.first > b.first;
+}
+
+/// Returns the current time in seconds since epoch.
+inline uint currentTime()
+{
+    return QDateTime::currentDateTime().toTime_t();
+}
+
+}
+
+
+// ************************************************************************** //
+// **********             STATIC METHODS AND VARIABLES             ********** //
+// ************************************************************************** //
+
+const double  LaunchHistory::HALF_LIFE      = 14 * 24 * 60 * 60;
+const int     LaunchHistory::MAX_LOG_LENGTH = 128;
+const quint32 LaunchHistory::TABLE_VERSION  = 1;
+
+LaunchHistory *LaunchHistory::instance = NULL;
+
+LaunchHistory *LaunchHistory::getInstance()
+{
+    if (LaunchHistory::instance == NULL) {
+        LaunchHistory::instance = new LaunchHistory();
+        LaunchHistory::instance->load();
+    }
+
+    return LaunchHistory::instance;
+}
+
+QString LaunchHistory::getTablePath()
+{
+    return KStandardDirs::locateLocal("cache", "takeoff/launches.table", true);
+}
+
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+LaunchHistory::LaunchHistory()
+        : QObject(),
+          epoch(currentTime()),
+          logLength(0),
+          writer(new QThreadPool(this))
+{
+    this->writer->setMaxThreadCount(1);
+
+    // The queued launches would be lost otherwise
+    connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()),
+            this, SLOT(flush()));
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC METHODS                    ********** //
+// ************************************************************************** //
+
+void LaunchHistory::addLaunch(const QString &desktopFile)
+{
+    uint now = currentTime();
+    this->applyLaunch(desktopFile, now);
+
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out << quint32(now) << desktopFile;
+    this->writer->start(new AppendJob(getTablePath(), record));
+
+    this->logLength++;
+    if (this->logLength >= MAX_LOG_LENGTH)
+        this->compact();
+}
+
+double LaunchHistory::getScore(const QString &desktopFile) const
+{
+    if (!this->entries.contains(desktopFile))
+        return 0;
+
+    return this->entries.value(desktopFile).weight * getDecay(currentTime());
+}
+
+QHash<QString, double> LaunchHistory::getScores() const
+{
+    double decay = this->getDecay(currentTime());
+
+    QHash<QString, double> ret;
+    QHashIterator<QString, Entry> it(this->entries);
+    while (it.hasNext()) {
+        it.next();
+        ret.insert(it.key(), it.value().weight * decay);
+    }
+
+    return ret;
+}
+
+QStringList LaunchHistory::getMostUsed(int count) const
+{
+    // All the weights have the same decay, so it is not necessary to apply it
+    QList< QPair<double, QString> > sorted;
+    QHashIterator<QString, Entry> it(this->entries);
+    while (it.hasNext()) {
+        it.next();
+        sorted.append(qMakePair(it.value().weight, it.key()));
+    }
+    qSort(sorted.begin(), sorted.end(), moreUsed);
+
+    QStringList ret;
+    for (int n=0; n<sorted.length() && n<count; n++)
+        ret.append(sorted.at(n).second);
+
+    return ret;
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC SLOTS                      ********** //
+// ************************************************************************** //
+
+void LaunchHistory::flush()
+{
+    this->writer->waitForDone();
+}
+
+
+// ************************************************************************** //
+// **********                   PRIVATE METHODS                    ********** //
+// ************************************************************************** //
+
+void LaunchHistory::load()
+{
+    uint now = currentTime();
+
+    // The file is read at once and parsed from memory. Without a valid table
+    // a new one is written, so the launches are appended after it
+    bool mustCompact = true;
+    QFile table(getTablePath());
+    QByteArray data;
+    if (table.open(QIODevice::ReadOnly))
+        data = table.readAll();
+
+    QDataStream in(data);
+    quint32 version, epoch, count;
+    in >> version >> epoch >> count;
+
+    if (in.status() == QDataStream::Ok && version == TABLE_VERSION) {
+        this->epoch = epoch;
+        for (quint32 n=0; n<count && in.status() == QDataStream::Ok; n++) {
+            QString desktopFile;
+            Entry entry;
+            in >> desktopFile >> entry.weight >> entry.count
+                    >> entry.lastLaunch;
+            if (in.status() == QDataStream::Ok)
+                this->entries.insert(desktopFile, entry);
+        }
+
+        // The launches appended after the table
+        mustCompact = in.status() != QDataStream::Ok;
+        while (!mustCompact && !in.atEnd()) {
+            quint32 time;
+            QString desktopFile;
+            in >> time >> desktopFile;
+
+            // A launch half written, the next ones would be appended after it
+            mustCompact = in.status() != QDataStream::Ok;
+            if (mustCompact)
+                break;
+
+            this->applyLaunch(desktopFile, time);
+            this->logLength++;
+        }
+    }
+
+    // Move the epoch forward to keep the weights in the range of a double
+    if (now > this->epoch && (now - this->epoch) / HALF_LIFE > 64) {
+        double decay = this->getDecay(now);
+        QMutableHashIterator<QString, Entry> it(this->entries);
+        while (it.hasNext()) {
+            it.next();
+            it.value().weight *= decay;
+        }
+
+        this->epoch = now;
+        mustCompact = true;
+    }
+
+    if (mustCompact || this->logLength > 0)
+        this->compact();
+}
+
+void LaunchHistory::applyLaunch(const QString &desktopFile, uint time)
+{
+    Entry &entry = this->entries[desktopFile];
+    if (entry.count == 0) {
+        entry.weight = 0;
+        entry.lastLaunch = 0;
+    }
+
+    entry.weight += pow(2.0, (double(time) - double(this->epoch)) / HALF_LIFE);
+    entry.count++;
+    if (time > entry.lastLaunch)
+        entry.lastLaunch = time;
+}
+
+double LaunchHistory::getDecay(uint time) const
+{
+    return pow(2.0, -(double(time) - double(this->epoch)) / HALF_LIFE);
+}
+
+void LaunchHistory::compact()
+{
+    this->writer->start(new CompactJob(getTablePath(), this->entries,
+            this->epoch, TABLE_VERSION));
+    this->logLength = 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file /src/takeoff/model/history/LaunchHistory.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  LaunchHistory
+ */
+#ifndef MODEL_LAUNCHHISTORY_H
+#define MODEL_LAUNCHHISTORY_H
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+class QThreadPool;
+
+/**
+ * Remembers the launched applications. The history is a single file in the
+ * cache directory: a table with the frecency of each application (the number
+ * of launches with an exponential decay, so the recent launches weigh more
+ * than the old ones) followed by the launches appended since the table was
+ * written. From time to time the launches are compacted into the table. The
+ * file is read at once on startup and the pending writes are finished before
+ * the application quits.
+ */
+class LaunchHistory : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * Only method to get an instance of the class. The history is loaded the
+     * first time.
+     * @return The single instance of the class.
+     */
+    static LaunchHistory *getInstance();
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Records a launch of the specified application. The file is written in
+     * other thread.
+     * @param desktopFile The desktop file of the application.
+     */
+    void addLaunch(const QString &desktopFile);
+
+    /**
+     * Returns the frecency of the specified application.
+     * @param  desktopFile The desktop file of the application.
+     * @return The frecency, 0 if it was never launched.
+     */
+    double getScore(const QString &desktopFile) const;
+
+    /**
+     * Returns the frecency of all the launched applications.
+     * @return Hash with the frecency of each desktop file.
+     */
+    QHash<QString, double> getScores() const;
+
+    /**
+     * Returns the applications with the highest frecency.
+     * @param  count Maximum number of applications to return.
+     * @return The desktop files, the most used first.
+     */
+    QStringList getMostUsed(int count) const;
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Information about the launches of an application. The weight is the sum
+     * of 2^((launch - epoch) / HALF_LIFE) of every launch, to update it in
+     * constant time.
+     */
+    struct Entry {
+        double weight;
+        quint32 count;
+        quint32 lastLaunch;
+    };
+
+public slots:
+
+    /**
+     * Waits until the file is written. Called when the application is about
+     * to quit.
+     */
+    void flush();
+
+private:
+
+    /// Reads the table and the appended launches and compacts them if needed.
+    void load();
+
+    /**
+     * Adds a launch to the in-memory table.
+     * @param desktopFile The desktop file of the application.
+     * @param time        The time of the launch (seconds since epoch).
+     */
+    void applyLaunch(const QString &desktopFile, uint time);
+
+    /**
+     * Returns the decay to apply to the weights at the specified time.
+     * @param  time The time (seconds since epoch).
+     * @return The factor to multiply the weights.
+     */
+    double getDecay(uint time) const;
+
+    /// Writes the table, without the appended launches, in the writer thread.
+    void compact();
+
+    /// Returns the path of the history file.
+    static QString getTablePath();
+
+    //--------------------------------------------------------------------------
+
+    /// Half-life of a launch, in seconds.
+    static const double HALF_LIFE;
+
+    /// Number of appended launches that trigger a compaction.
+    static const int MAX_LOG_LENGTH;
+
+    /// Version of the table file format.
+    static const quint32 TABLE_VERSION;
+
+    /// Launches of each application, by desktop file.
+    QHash<QString, Entry> entries;
+
+    /// Reference time of the weights (seconds since epoch).
+    quint32 epoch;
+
+    /// Number of launches appended after the table.
+    int logLength;
+
+    /// Thread where the files are written, one job at a time.
+    QThreadPool *writer;
+
+    /// Single instance of the class.
+    static LaunchHistory *instance;
+
+    // Hide constructors
+    LaunchHistory();
+    LaunchHistory(const LaunchHistory&);
+    const LaunchHistory &operator = (const LaunchHistory&);
+
+};
+
+#endif // MODEL_LAUNCHHISTORY_H
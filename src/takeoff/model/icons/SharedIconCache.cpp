@@ -0,0 +1,455 @@
+/**
+ * @file /src/takeoff/model/icons/SharedIconCache.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  SharedIconCache
+ */
+#include "SharedIconCache.h"
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
+#include <QtGui/QImage>
+#include <QtGui/QPixmap>
+
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/// Identifies the files of the cache, "TKIC".
+const quint32 MAGIC = 0x544B4943;
+
+/// Version of the file format.
+const quint32 VERSION = 1;
+
+/// Maximum width and height of a cached icon.
+const quint32 MAX_ICON_SIZE = 512;
+
+/// Maximum size of the key and the source file of an entry.
+const quint32 MAX_STRING_SIZE = 4096;
+
+/// Rounds a size up to a multiple of 4, so the entries are aligned.
+inline quint32 align(quint32 size)
+{
+    return (size + 3) & ~3u;
+}
+
+}
+
+
+// ************************************************************************** //
+// **********             STATIC METHODS AND VARIABLES             ********** //
+// ************************************************************************** //
+
+SharedIconCache *SharedIconCache::instance = NULL;
+
+SharedIconCache *SharedIconCache::getInstance()
+{
+    if (SharedIconCache::instance == NULL)
+        SharedIconCache::instance = new SharedIconCache();
+
+    return SharedIconCache::instance;
+}
+
+QString SharedIconCache::getDirectory()
+{
+    QString path = QFile::decodeName(::getenv("TAKEOFF_ICON_CACHE"));
+    return path.isEmpty() ? QString("/var/cache/takeoff/icons") : path;
+}
+
+bool SharedIconCache::map(Mapping *mapping, bool writable)
+{
+    mapping->data = NULL;
+    mapping->fd   = -1;
+
+    QByteArray path = QFile::encodeName(mapping->path);
+    int fd = writable
+            ? ::open(path.constData(), O_RDWR | O_CREAT | O_NOFOLLOW, 0644)
+            : ::open(path.constData(), O_RDONLY | O_NOFOLLOW);
+    if (fd == -1)
+        return false;
+
+    // The first session of the user creates the file
+    if (writable && ::flock(fd, LOCK_EX) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    struct stat info;
+    bool valid = ::fstat(fd, &info) == 0 && S_ISREG(info.st_mode)
+            && (info.st_mode & (S_IWGRP | S_IWOTH)) == 0
+            && (!writable || info.st_uid == ::getuid());
+    if (valid && writable && info.st_size == 0)
+        valid = ::fchmod(fd, 0644) == 0 && ::ftruncate(fd, CAPACITY) == 0;
+    else if (valid)
+        valid = info.st_size == CAPACITY;
+
+    // The owner of other file could truncate it, and accessing the truncated
+    // part of a mapping raises SIGBUS, so only the file of the user is mapped
+    if (!writable) {
+        quint32 fields[3];
+        valid = valid
+                && ::pread(fd, fields, sizeof(fields), 0) == sizeof(fields)
+                && fields[0] == MAGIC && fields[1] == VERSION
+                && fields[2] == (quint32)CAPACITY;
+        if (!valid) {
+            ::close(fd);
+            return false;
+        }
+
+        mapping->fd = fd;
+        return true;
+    }
+
+    void *data = MAP_FAILED;
+    if (valid) {
+        data = ::mmap(NULL, CAPACITY, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                0);
+    }
+
+    if (data != MAP_FAILED) {
+        Header *header = (Header *)data;
+        if (header->magic == 0) {
+            header->version  = VERSION;
+            header->capacity = CAPACITY;
+            header->count    = 0;
+            header->end      = sizeof(Header);
+            header->magic    = MAGIC;
+        }
+
+        if (header->magic != MAGIC || header->version != VERSION
+                || header->capacity != (quint32)CAPACITY) {
+            ::munmap(data, CAPACITY);
+            data = MAP_FAILED;
+        }
+    }
+
+    ::flock(fd, LOCK_UN);
+
+    if (data == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    mapping->data = (uchar *)data;
+    mapping->fd   = fd;
+    return true;
+}
+
+void SharedIconCache::unmap(Mapping *mapping)
+{
+    if (mapping->data != NULL)
+        ::munmap(mapping->data, CAPACITY);
+    if (mapping->fd != -1)
+        ::close(mapping->fd);
+
+    mapping->data = NULL;
+    mapping->fd   = -1;
+}
+
+bool SharedIconCache::remapIfRetired(Mapping *mapping, bool writable)
+{
+    if (mapping->fd == -1)
+        return false;
+
+    int retired;
+    if (!read(mapping, offsetof(Header, retired), &retired, sizeof(retired)))
+        return false;
+    if (retired == 0)
+        return true;
+
+    unmap(mapping);
+    return map(mapping, writable);
+}
+
+bool SharedIconCache::read(const Mapping *mapping, quint32 offset, void *dest,
+        quint32 size)
+{
+    if (offset > (quint32)CAPACITY || size > CAPACITY - offset)
+        return false;
+
+    if (mapping->data != NULL) {
+        ::memcpy(dest, mapping->data + offset, size);
+        return true;
+    }
+
+    return ::pread(mapping->fd, dest, size, offset) == (ssize_t)size;
+}
+
+quint32 SharedIconCache::lookup(const Mapping *mapping, uint hash,
+        const QByteArray &key, Entry *entry)
+{
+    QByteArray entryKey;
+    for (int n=0; n<TABLE_SIZE; n++) {
+        // The offset is published after the entry is written, and the entry is
+        // read through the offset, so no barrier is needed
+        quint32 offset;
+        quint32 bucket = offsetof(Header, buckets)
+                + ((hash + n) % TABLE_SIZE) * sizeof(QBasicAtomicInt);
+        if (!read(mapping, bucket, &offset, sizeof(offset)) || offset == 0)
+            return 0;
+
+        if (offset < sizeof(Header) || offset % 4 != 0
+                || !read(mapping, offset, entry, sizeof(Entry)))
+            return 0;
+
+        if (entry->width > MAX_ICON_SIZE || entry->height > MAX_ICON_SIZE
+                || entry->keySize > MAX_STRING_SIZE
+                || entry->sourceSize > MAX_STRING_SIZE)
+            return 0;
+
+        quint32 pixelsOffset = align(sizeof(Entry) + entry->keySize
+                + entry->sourceSize);
+        if (entry->size != pixelsOffset + entry->width * entry->height * 4
+                || entry->size > CAPACITY - offset)
+            return 0;
+
+        if (entry->hash != hash || entry->keySize != (quint32)key.size())
+            continue;
+
+        entryKey.resize(key.size());
+        if (read(mapping, offset + sizeof(Entry), entryKey.data(), key.size())
+                && entryKey == key)
+            return offset + pixelsOffset;
+    }
+
+    return 0;
+}
+
+bool SharedIconCache::append(uchar *data, const Entry &entry,
+        const QByteArray &key, const QByteArray &source, const uchar *pixels)
+{
+    Header *header = (Header *)data;
+    quint32 offset = int(header->end);
+    if (header->count >= (quint32)MAX_ENTRIES
+            || entry.size > CAPACITY - offset)
+        return false;
+
+    uchar *dest = data + offset;
+    ::memcpy(dest, &entry, sizeof(Entry));
+    ::memcpy(dest + sizeof(Entry), key.constData(), key.size());
+    ::memcpy(dest + sizeof(Entry) + key.size(), source.constData(),
+            source.size());
+    ::memcpy(dest + align(sizeof(Entry) + key.size() + source.size()), pixels,
+            entry.width * entry.height * 4);
+
+    header->end = offset + entry.size;
+    header->count++;
+
+    // Publish the entry once it is written, the readers don't take the lock
+    int n = entry.hash % TABLE_SIZE;
+    while (!header->buckets[n].testAndSetRelease(0, offset))
+        n = (n + 1) % TABLE_SIZE;
+
+    return true;
+}
+
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+SharedIconCache::SharedIconCache()
+{
+    this->ownFile.data = NULL;
+    this->ownFile.fd   = -1;
+
+    // The permissions of the directory decide who can publish icons
+    QString dirName = getDirectory();
+    struct stat info;
+    if (::stat(QFile::encodeName(dirName).constData(), &info) != 0
+            || !S_ISDIR(info.st_mode)
+            || (info.st_uid != 0 && info.st_uid != ::getuid())
+            || (info.st_mode & S_IWOTH) != 0)
+        return;
+
+    // Without write permission the user only reads the icons of the others
+    QString ownName = QString("%1.cache").arg(::getuid());
+    this->ownFile.path = dirName + "/" + ownName;
+    map(&this->ownFile, true);
+
+    QDir dir(dirName);
+    QStringList names = dir.entryList(QStringList("*.cache"), QDir::Files);
+    foreach (const QString &name, names) {
+        if (name == ownName || this->foreignFiles.size() >= MAX_FOREIGN_FILES)
+            continue;
+
+        Mapping mapping;
+        mapping.path = dir.filePath(name);
+        if (map(&mapping, false))
+            this->foreignFiles.append(mapping);
+    }
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC METHODS                    ********** //
+// ************************************************************************** //
+
+bool SharedIconCache::find(const QString &key, QPixmap *pixmap)
+{
+    QByteArray utf8Key = key.toUtf8();
+    uint hash = qHash(key);
+    Entry entry;
+    const Mapping *file = NULL;
+    quint32 pixels = 0;
+
+    if (remapIfRetired(&this->ownFile, true)) {
+        file = &this->ownFile;
+        pixels = lookup(file, hash, utf8Key, &entry);
+    }
+
+    for (int n=0; pixels == 0 && n<this->foreignFiles.size(); n++) {
+        if (remapIfRetired(&this->foreignFiles[n], false)) {
+            file = &this->foreignFiles[n];
+            pixels = lookup(file, hash, utf8Key, &entry);
+        }
+    }
+
+    if (pixels == 0)
+        return false;
+
+    // The pixels are copied because the file could be unmapped after a
+    // compaction, or truncated if it belongs to other user
+    QImage image(entry.width, entry.height,
+            QImage::Format_ARGB32_Premultiplied);
+    if (image.isNull() || !read(file, pixels, image.bits(),
+            entry.width * entry.height * 4))
+        return false;
+
+    *pixmap = QPixmap::fromImage(image);
+    return true;
+}
+
+void SharedIconCache::insert(const QString &key, const QString &source,
+        uint mtime, const QImage &image)
+{
+    if (this->ownFile.data == NULL || image.isNull()
+            || (quint32)image.width() > MAX_ICON_SIZE
+            || (quint32)image.height() > MAX_ICON_SIZE)
+        return;
+
+    const QImage argb = image.convertToFormat(
+            QImage::Format_ARGB32_Premultiplied);
+    QByteArray utf8Key = key.toUtf8();
+    QByteArray utf8Source = QFile::encodeName(source);
+    if ((quint32)utf8Key.size() > MAX_STRING_SIZE
+            || (quint32)utf8Source.size() > MAX_STRING_SIZE)
+        return;
+
+    Entry entry;
+    entry.hash       = qHash(key);
+    entry.keySize    = utf8Key.size();
+    entry.sourceSize = utf8Source.size();
+    entry.mtime      = mtime;
+    entry.width      = argb.width();
+    entry.height     = argb.height();
+    entry.size       = align(sizeof(Entry) + entry.keySize + entry.sourceSize)
+            + entry.width * entry.height * 4;
+
+    // Lock the current file, other session could have compacted it
+    while (true) {
+        if (!remapIfRetired(&this->ownFile, true)
+                || ::flock(this->ownFile.fd, LOCK_EX) != 0)
+            return;
+
+        const Header *header = (const Header *)this->ownFile.data;
+        if (int(header->retired) == 0)
+            break;
+        ::flock(this->ownFile.fd, LOCK_UN);
+    }
+
+    // Other session could have published the icon while it was rendered
+    Entry existing;
+    if (lookup(&this->ownFile, entry.hash, utf8Key, &existing) == 0) {
+        if (!append(this->ownFile.data, entry, utf8Key, utf8Source,
+                argb.bits()) && this->compact())
+            append(this->ownFile.data, entry, utf8Key, utf8Source, argb.bits());
+    }
+
+    ::flock(this->ownFile.fd, LOCK_UN);
+}
+
+
+// ************************************************************************** //
+// **********                   PRIVATE METHODS                    ********** //
+// ************************************************************************** //
+
+bool SharedIconCache::compact()
+{
+    // No other session of the user is compacting, the old file is locked
+    Mapping newFile;
+    newFile.path = this->ownFile.path + ".new";
+    QByteArray newPath = QFile::encodeName(newFile.path);
+    ::unlink(newPath.constData());
+    if (!map(&newFile, true))
+        return false;
+    ::flock(newFile.fd, LOCK_EX);
+
+    // Keep the icons whose source didn't change, up to half of the file
+    const Header *header = (const Header *)this->ownFile.data;
+    const Header *newHeader = (const Header *)newFile.data;
+    for (int n=0; n<TABLE_SIZE; n++) {
+        quint32 offset = int(header->buckets[n]);
+        if (offset == 0)
+            continue;
+
+        Entry entry;
+        ::memcpy(&entry, this->ownFile.data + offset, sizeof(Entry));
+        const char *strings = (const char *)this->ownFile.data + offset
+                + sizeof(Entry);
+        QByteArray key(strings, entry.keySize);
+        QByteArray source(strings + entry.keySize, entry.sourceSize);
+
+        QFileInfo sourceInfo(QFile::decodeName(source));
+        if (sourceInfo.lastModified().toTime_t() != entry.mtime)
+            continue;
+
+        if (newHeader->count >= (quint32)MAX_ENTRIES / 2
+                || int(newHeader->end) + entry.size > (quint32)CAPACITY / 2)
+            break;
+
+        append(newFile.data, entry, key, source, this->ownFile.data + offset
+                + align(sizeof(Entry) + entry.keySize + entry.sourceSize));
+    }
+
+    if (::rename(newPath.constData(),
+            QFile::encodeName(this->ownFile.path).constData()) != 0) {
+        unmap(&newFile);
+        ::unlink(newPath.constData());
+        return false;
+    }
+
+    // The other sessions map the new file in their next lookup
+    Header *oldHeader = (Header *)this->ownFile.data;
+    oldHeader->retired = 1;
+    unmap(&this->ownFile);
+    this->ownFile = newFile;
+    return true;
+}
@@ -0,0 +1,221 @@
+/**
+ * @file /src/takeoff/model/icons/SharedIconCache.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  SharedIconCache
+ */
+#ifndef MODEL_SHAREDICONCACHE_H
+#define MODEL_SHAREDICONCACHE_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QString>
+class QImage;
+class QPixmap;
+
+/**
+ * Cache of rendered icons shared by the sessions of the host, so an icon is
+ * rasterized once and the other sessions only upload its pixels.
+ *
+ * Each user publishes the icons it renders in its own file, mapped in memory
+ * by the sessions of the user. The files of the other users are read with
+ * pread() instead, so a file truncated by its owner makes the lookups fail
+ * rather than raising SIGBUS. The files are hash tables where the entries are
+ * only appended: the lookups take no locks and the sessions of the same user
+ * take a file lock to append. When a file is full it is compacted, keeping
+ * the entries whose source file didn't change.
+ *
+ * The cache is only used if the administrator creates its directory, see
+ * getDirectory(). There is no trust boundary between the users that can write
+ * in it: any of them can publish the pixmap of any icon, and the sessions of
+ * the others display it. The entries are validated only to be read safely, so
+ * the directory must be writable only by mutually trusted users, for example
+ * a group of the administrators, or only by root.
+ */
+class SharedIconCache
+{
+
+public:
+
+    /**
+     * Only method to get an instance of the class. The files are mapped the
+     * first time.
+     * @return The single instance of the class.
+     */
+    static SharedIconCache *getInstance();
+
+    /**
+     * Returns the directory of the cache, TAKEOFF_ICON_CACHE or a fixed path in
+     * /var/cache. It must belong to root, or to the user, and the other users
+     * can't write in it.
+     * @return The path.
+     */
+    static QString getDirectory();
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Looks for an icon in the caches of all the users, without locks.
+     * @param  key    The key of the icon: theme, name, size and modification
+     *                time of the source file.
+     * @param  pixmap Where the icon is returned.
+     * @return If the icon was found.
+     */
+    bool find(const QString &key, QPixmap *pixmap);
+
+    /**
+     * Publishes an icon in the cache of the user. Does nothing if the user
+     * can't write in the directory of the cache.
+     * @param key    The key of the icon, see find().
+     * @param source The source file of the icon, to compact the cache.
+     * @param mtime  The modification time of the source file.
+     * @param image  The rendered icon.
+     */
+    void insert(const QString &key, const QString &source, uint mtime,
+            const QImage &image);
+
+private:
+
+    /// Size of the hash table of a file.
+    static const int TABLE_SIZE = 4096;
+
+    /// Maximum number of entries of a file, then it is compacted.
+    static const int MAX_ENTRIES = TABLE_SIZE * 3 / 4;
+
+    /// Size of a file. The files are sparse, only the used part takes disk.
+    static const int CAPACITY = 16 * 1024 * 1024;
+
+    /// Maximum number of files of other users that are mapped.
+    static const int MAX_FOREIGN_FILES = 16;
+
+    /// Beginning of a file.
+    struct Header {
+        quint32 magic;
+        quint32 version;
+        quint32 capacity;
+        quint32 count;
+        QBasicAtomicInt end;
+        QBasicAtomicInt retired;
+        QBasicAtomicInt buckets[TABLE_SIZE];
+    };
+
+    /// An icon. It is followed by the key, the source file and the pixels.
+    struct Entry {
+        quint32 hash;
+        quint32 keySize;
+        quint32 sourceSize;
+        quint32 mtime;
+        quint32 width;
+        quint32 height;
+        quint32 size;
+    };
+
+    /// A file of the cache. Only the file of the user is mapped.
+    struct Mapping {
+        QString path;
+        uchar *data;
+        int fd;
+    };
+
+    /**
+     * Hidden constructor. Maps the file of the user, creating it if possible,
+     * and the files of the other users.
+     */
+    SharedIconCache();
+
+    /**
+     * Opens a file, and maps it if it is the file of the user.
+     * @param  mapping  The mapping, with its path set.
+     * @param  writable If the file is the file of the user. It is created if it
+     *                  doesn't exist and mapped to write in it. Otherwise the
+     *                  file is read with pread().
+     * @return If the file was opened.
+     */
+    static bool map(Mapping *mapping, bool writable);
+
+    /**
+     * Unmaps and closes a file.
+     * @param mapping The mapping.
+     */
+    static void unmap(Mapping *mapping);
+
+    /**
+     * Opens a file again if it was replaced by a compaction.
+     * @param  mapping  The mapping.
+     * @param  writable If the file is the file of the user.
+     * @return If the file is open.
+     */
+    static bool remapIfRetired(Mapping *mapping, bool writable);
+
+    /**
+     * Copies a part of a file. The files of the other users are read with
+     * pread(), because they could be truncated.
+     * @param  mapping The mapping.
+     * @param  offset  The offset of the part.
+     * @param  dest    Where the part is copied.
+     * @param  size    The size of the part.
+     * @return If the whole part was read.
+     */
+    static bool read(const Mapping *mapping, quint32 offset, void *dest,
+            quint32 size);
+
+    /**
+     * Looks for an entry in a file. The file could be written by other users,
+     * so every offset and size is checked.
+     * @param  mapping The mapping.
+     * @param  hash    The hash of the key.
+     * @param  key     The key in UTF-8.
+     * @param  entry   Where a copy of the entry is returned.
+     * @return The offset of the pixels of the entry or 0 if it isn't found.
+     */
+    static quint32 lookup(const Mapping *mapping, uint hash,
+            const QByteArray &key, Entry *entry);
+
+    /**
+     * Appends an entry to the file of the user, that must be locked.
+     * @param  data   The mapped file.
+     * @param  entry  The entry, with its size set.
+     * @param  key    The key in UTF-8.
+     * @param  source The source file in UTF-8.
+     * @param  pixels The pixels.
+     * @return If there was room for the entry.
+     */
+    static bool append(uchar *data, const Entry &entry, const QByteArray &key,
+            const QByteArray &source, const uchar *pixels);
+
+    /**
+     * Replaces the file of the user, that must be locked, with a new file with
+     * the entries whose source file didn't change. The new file is locked.
+     * @return If the file was compacted.
+     */
+    bool compact();
+
+    //--------------------------------------------------------------------------
+
+    /// The file of the user, if it can write in the directory.
+    Mapping ownFile;
+
+    /// The files of the other users.
+    QList<Mapping> foreignFiles;
+
+    /// Single instance of the class.
+    static SharedIconCache *instance;
+
+};
+
+#endif // MODEL_SHAREDICONCACHE_H
@@ -0,0 +1,129 @@
+/**
+ * @file /src/takeoff/model/icons/SharedIconEngine.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  SharedIconEngine
+ */
+#include "SharedIconEngine.h"
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtGui/QPainter>
+#include <QtGui/QPixmapCache>
+#include <KDE/KIconLoader>
+#include <KDE/KIconTheme>
+#include "SharedIconCache.h"
+#include "../../metrics/Metrics.h"
+#include "../../trace/Trace.h"
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+SharedIconEngine::SharedIconEngine(const QString &iconName)
+        : iconName(iconName),
+          icon(iconName)
+{
+
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC METHODS                    ********** //
+// ************************************************************************** //
+
+void SharedIconEngine::paint(QPainter *painter, const QRect &rect,
+        QIcon::Mode mode, QIcon::State state)
+{
+    QPixmap pixmap = this->pixmap(rect.size(), mode, state);
+    painter->drawPixmap(rect.x() + (rect.width() - pixmap.width()) / 2,
+            rect.y() + (rect.height() - pixmap.height()) / 2, pixmap);
+}
+
+QSize SharedIconEngine::actualSize(const QSize &size, QIcon::Mode mode,
+        QIcon::State state)
+{
+    return this->icon.actualSize(size, mode, state);
+}
+
+QPixmap SharedIconEngine::pixmap(const QSize &size, QIcon::Mode mode,
+        QIcon::State state)
+{
+    int extent = qMin(size.width(), size.height());
+    if (state != QIcon::Off || (mode != QIcon::Normal && mode != QIcon::Active)
+            || extent <= 0)
+        return this->icon.pixmap(size, mode, state);
+
+    const Source &source = this->getSource(extent);
+    if (source.path.isEmpty())
+        return this->icon.pixmap(size, mode, state);
+
+    QString key = source.key + QString::number(mode);
+
+    QPixmap pixmap;
+    if (QPixmapCache::find(key, &pixmap))
+        return pixmap;
+
+    SharedIconCache *cache = SharedIconCache::getInstance();
+    if (cache->find(key, &pixmap)) {
+        Metrics::add(Metrics::SHARED_ICON_HITS);
+    } else {
+        TAKEOFF_TRACE_SPAN("SharedIconEngine::render");
+        Metrics::add(Metrics::SHARED_ICON_MISSES);
+        pixmap = this->icon.pixmap(QSize(extent, extent), mode, state);
+        cache->insert(key, source.path, source.mtime, pixmap.toImage());
+    }
+
+    QPixmapCache::insert(key, pixmap);
+    return pixmap;
+}
+
+QString SharedIconEngine::key() const
+{
+    return "SharedIconEngine";
+}
+
+QIconEngineV2 *SharedIconEngine::clone() const
+{
+    return new SharedIconEngine(this->iconName);
+}
+
+
+// ************************************************************************** //
+// **********                   PRIVATE METHODS                    ********** //
+// ************************************************************************** //
+
+const SharedIconEngine::Source &SharedIconEngine::getSource(int extent)
+{
+    KIconLoader *loader = KIconLoader::global();
+    QString theme = (loader->theme() != NULL)
+            ? loader->theme()->internalName() : QString();
+
+    QHash<int, Source>::iterator it = this->sources.find(extent);
+    if (it != this->sources.end() && it->theme == theme)
+        return *it;
+
+    // The key changes when the theme or the source file change
+    Source source;
+    source.theme = theme;
+    source.path  = loader->iconPath(this->iconName, -extent, true);
+    source.mtime = source.path.isEmpty()
+            ? 0 : QFileInfo(source.path).lastModified().toTime_t();
+    source.key   = QString("%1/%2/%3/%4/").arg(theme).arg(this->iconName)
+            .arg(extent).arg(source.mtime);
+
+    return *this->sources.insert(extent, source);
+}
@@ -0,0 +1,90 @@
+/**
+ * @file /src/takeoff/model/icons/SharedIconEngine.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  SharedIconEngine
+ */
+#ifndef MODEL_SHAREDICONENGINE_H
+#define MODEL_SHAREDICONENGINE_H
+
+#include <QtCore/QHash>
+#include <QtGui/QIconEngineV2>
+#include <KDE/KIcon>
+
+/**
+ * Icon engine of the launchers. The icons are rendered by KIcon the first time
+ * they are used in the host and then read from SharedIconCache, so the other
+ * sessions don't rasterize them again.
+ *
+ * Only the normal and active icons are shared, the rest of modes and states
+ * are rendered by KIcon. The source file of each size is looked up once, while
+ * the icon theme doesn't change.
+ */
+class SharedIconEngine : public QIconEngineV2
+{
+
+public:
+
+    /**
+     * Default constructor.
+     * @param iconName The name of the icon in the theme, or its path.
+     */
+    SharedIconEngine(const QString &iconName);
+
+    //--------------------------------------------------------------------------
+
+    virtual void paint(QPainter *painter, const QRect &rect, QIcon::Mode mode,
+            QIcon::State state);
+    virtual QSize actualSize(const QSize &size, QIcon::Mode mode,
+            QIcon::State state);
+    virtual QPixmap pixmap(const QSize &size, QIcon::Mode mode,
+            QIcon::State state);
+    virtual QString key() const;
+    virtual QIconEngineV2 *clone() const;
+
+private:
+
+    /// Source file of the icon for a size.
+    struct Source {
+        QString theme;
+        QString path;
+        uint mtime;
+        QString key;
+    };
+
+    /**
+     * Returns the source file of the icon for the specified size, looking it up
+     * only the first time or if the theme has changed.
+     * @param  extent The size.
+     * @return The source file, with an empty path if the icon isn't found.
+     */
+    const Source &getSource(int extent);
+
+    //--------------------------------------------------------------------------
+
+    /// The name of the icon.
+    QString iconName;
+
+    /// The icon that renders the pixmaps that are not shared.
+    KIcon icon;
+
+    /// Source files of the icon by size.
+    QHash<int, Source> sources;
+
+};
+
+#endif // MODEL_SHAREDICONENGINE_H
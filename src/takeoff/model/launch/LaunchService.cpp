@@ -0,0 +1,243 @@
+/**
+ * @file /src/takeoff/model/launch/LaunchService.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  LaunchService
+ */
+#include "LaunchService.h"
+#include <errno.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QTimer>
+#include <QtCore/QVarLengthArray>
+#include <KDE/KDebug>
+#include <KDE/KRun>
+#include <KDE/KUrl>
+#include "Prefetcher.h"
+#include "../config/Config.h"
+#include "../../metrics/Metrics.h"
+#include "../menu/qtxdg/xdgdesktopfile.h"
+
+extern char **environ;
+
+// ************************************************************************** //
+// **********             STATIC METHODS AND VARIABLES             ********** //
+// ************************************************************************** //
+
+LaunchService *LaunchService::instance = NULL;
+
+LaunchService *LaunchService::getInstance()
+{
+    if (LaunchService::instance == NULL)
+        LaunchService::instance = new LaunchService();
+
+    return LaunchService::instance;
+}
+
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+LaunchService::LaunchService()
+        : reapTimer(new QTimer(this))
+{
+    this->reapTimer->setInterval(REAP_INTERVAL);
+    connect(this->reapTimer, SIGNAL(timeout()), this, SLOT(reap()));
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC METHODS                    ********** //
+// ************************************************************************** //
+
+void LaunchService::launch(const QString &desktopFile)
+{
+    QElapsedTimer latency;
+    latency.start();
+
+    const Command &command = this->getCommand(desktopFile);
+    if (!command.argv.isEmpty() && this->spawn(command, desktopFile)) {
+        Metrics::record(Metrics::SPAWN_LATENCY, latency.nsecsElapsed() / 1000);
+        return;
+    }
+
+    // KRun deletes itself when the application is started. It continues
+    // asynchronously, so the latency is only the time spent in Takeoff
+    new KRun(KUrl(desktopFile), NULL);
+    Metrics::record(Metrics::FALLBACK_LATENCY, latency.nsecsElapsed() / 1000);
+}
+
+void LaunchService::clear()
+{
+    this->commands.clear();
+}
+
+QString LaunchService::getExecutable(const QString &desktopFile)
+{
+    const Command &command = this->getCommand(desktopFile);
+    if (command.argv.isEmpty())
+        return QString();
+
+    QString program = QFile::decodeName(command.argv.first());
+    if (program.contains('/'))
+        return QFileInfo(program).absoluteFilePath();
+
+    // Same lookup as posix_spawnp
+    QStringList path = QString::fromLocal8Bit(::getenv("PATH")).split(':',
+            QString::SkipEmptyParts);
+    foreach (const QString &dir, path) {
+        QFileInfo info(QDir(dir), program);
+        if (info.isFile() && info.isExecutable())
+            return info.absoluteFilePath();
+    }
+
+    return QString();
+}
+
+
+// ************************************************************************** //
+// **********                    PRIVATE SLOTS                     ********** //
+// ************************************************************************** //
+
+void LaunchService::reap()
+{
+    // Only our children are waited, the rest belong to other parts of
+    // plasma-desktop
+    QMutableHashIterator<pid_t, QString> it(this->children);
+    while (it.hasNext()) {
+        it.next();
+        pid_t ret = ::waitpid(it.key(), NULL, WNOHANG);
+
+        // Finished, or already waited by the kernel if SIGCHLD is ignored
+        if (ret == it.key() || (ret == -1 && errno == ECHILD))
+            it.remove();
+    }
+
+    if (this->children.isEmpty())
+        this->reapTimer->stop();
+}
+
+void LaunchService::sample()
+{
+    if (this->pendingSamples.isEmpty())
+        return;
+
+    // Once the application has started, its libraries are mapped
+    pid_t pid = this->pendingSamples.takeFirst();
+    if (this->children.contains(pid)) {
+        Prefetcher::getInstance()->setFiles(this->children.value(pid),
+                Prefetcher::getMappedFiles(pid));
+    }
+}
+
+
+// ************************************************************************** //
+// **********                   PRIVATE METHODS                    ********** //
+// ************************************************************************** //
+
+const LaunchService::Command &LaunchService::getCommand(
+        const QString &desktopFile)
+{
+    // The desktop file can be edited in place without reloading the menu
+    QDateTime modified = QFileInfo(desktopFile).lastModified();
+    QHash<QString, Command>::iterator it = this->commands.find(desktopFile);
+    if (it != this->commands.end() && it.value().modified == modified)
+        return it.value();
+
+    // The entry parsed by the menu is used, it is read again only if the file
+    // was modified after that
+    XdgDesktopFile *entry = XdgDesktopFileCache::getFile(desktopFile);
+    XdgDesktopFileCache::refresh(entry);
+    it = this->commands.insert(desktopFile, compile(*entry));
+    return it.value();
+}
+
+LaunchService::Command LaunchService::compile(const XdgDesktopFile &entry)
+{
+    Command command;
+    command.modified = entry.lastModified();
+
+    if (!entry.isValid() || entry.type() != XdgDesktopFile::ApplicationType)
+        return command;
+
+    // Leave to KRun what can't be done with a plain exec
+    if (entry.value("Terminal").toBool()
+            || !entry.value("Path").toString().isEmpty())
+        return command;
+
+    QStringList args = entry.expandExecString();
+    if (args.isEmpty())
+        return command;
+
+    foreach (const QString &arg, args)
+        command.argv.append(QFile::encodeName(arg));
+
+    return command;
+}
+
+bool LaunchService::spawn(const Command &command,
+        const QString &desktopFile)
+{
+    QVarLengthArray<char*, 16> argv;
+    for (int n=0; n<command.argv.length(); n++)
+        argv.append(const_cast<char*>(command.argv.at(n).constData()));
+    argv.append(NULL);
+
+    // The child doesn't inherit the blocked signals of the plasmoid and gets
+    // its own process group, so it isn't affected by the signals sent to the
+    // group of the desktop shell. posix_spawn returns once the child has
+    // called exec (glibc uses CLONE_VFORK), without copying the address space
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK
+            | POSIX_SPAWN_SETPGROUP);
+
+    pid_t pid;
+    int error = ::posix_spawnp(&pid, argv[0], NULL, &attr, argv.data(),
+            environ);
+    posix_spawnattr_destroy(&attr);
+
+    if (error != 0) {
+        kDebug() << "posix_spawn failed:" << strerror(error);
+        return false;
+    }
+
+    this->children.insert(pid, desktopFile);
+    if (!this->reapTimer->isActive())
+        this->reapTimer->start();
+
+    if (Config::getInstance()->getValues().prefetchApplications) {
+        this->pendingSamples.append(pid);
+        QTimer::singleShot(SAMPLE_DELAY, this, SLOT(sample()));
+    }
+
+    return true;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file /src/takeoff/model/launch/LaunchService.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  LaunchService
+ */
+#ifndef MODEL_LAUNCHSERVICE_H
+#define MODEL_LAUNCHSERVICE_H
+
+#include <sys/types.h>
+#include <QtCore/QByteArray>
+#include <QtCore/QDateTime>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+class QTimer;
+class XdgDesktopFile;
+
+/**
+ * Starts the applications. The Exec line of each desktop file is expanded the
+ * first time, and again when the file is modified, and then the process is
+ * spawned directly with posix_spawn. The desktop files that need more than a
+ * command line (links, terminal applications, working directories...) are
+ * started with KRun.
+ *
+ * The spawned processes are waited by a timer that only runs while any of
+ * them is pending, so no signal handler is installed in plasma-desktop.
+ */
+class LaunchService : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * Only method to get an instance of the class.
+     * @return The single instance of the class.
+     */
+    static LaunchService *getInstance();
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Starts the application of the specified desktop file.
+     * @param desktopFile The desktop file of the application.
+     */
+    void launch(const QString &desktopFile);
+
+    /**
+     * Forgets the expanded commands, so they are read again from the desktop
+     * files. Call it when the menu is reloaded.
+     */
+    void clear();
+
+    /**
+     * Returns the absolute path of the program of a desktop file.
+     * @param  desktopFile The desktop file of the application.
+     * @return The path or an empty string if the program is not found or the
+     *         application is started with KRun.
+     */
+    QString getExecutable(const QString &desktopFile);
+
+private slots:
+
+    /// Waits for the finished processes, and stops the timer when there are
+    /// no more.
+    void reap();
+
+    /**
+     * Sends the files mapped by the oldest process that hasn't been sampled to
+     * the Prefetcher, once the application has started.
+     */
+    void sample();
+
+private:
+
+    /**
+     * Command line of an application, ready to spawn.
+     */
+    struct Command {
+        /// Arguments, the first one is the program. Empty to use KRun.
+        QList<QByteArray> argv;
+
+        /// Modification time of the desktop file when it was expanded.
+        QDateTime modified;
+    };
+
+    /**
+     * Returns the command of a desktop file, expanding it the first time or if
+     * the file has been modified.
+     * @param  desktopFile The desktop file.
+     * @return The command.
+     */
+    const Command &getCommand(const QString &desktopFile);
+
+    /**
+     * Expands the command of a desktop file.
+     * @param  entry The parsed desktop file.
+     * @return The command, with no arguments if it has to be started with KRun.
+     */
+    static Command compile(const XdgDesktopFile &entry);
+
+    /**
+     * Spawns a process.
+     * @param  command     The command to run.
+     * @param  desktopFile The desktop file of the application.
+     * @return If the process was started.
+     */
+    bool spawn(const Command &command, const QString &desktopFile);
+
+    //--------------------------------------------------------------------------
+
+    /// Milliseconds between the waits for the spawned processes.
+    static const int REAP_INTERVAL = 1000;
+
+    /// Milliseconds to wait before reading the files mapped by a process.
+    static const int SAMPLE_DELAY = 3000;
+
+    /// Expanded commands, by desktop file.
+    QHash<QString, Command> commands;
+
+    /// Spawned processes that haven't been waited yet, with their desktop
+    /// files.
+    QHash<pid_t, QString> children;
+
+    /// Spawned processes that haven't been sampled yet, in order.
+    QList<pid_t> pendingSamples;
+
+    /// Timer to wait for the children while there are any.
+    QTimer *reapTimer;
+
+    /// Single instance of the class.
+    static LaunchService *instance;
+
+    // Hide constructors
+    LaunchService();
+    LaunchService(const LaunchService&);
+    const LaunchService &operator = (const LaunchService&);
+
+};
+
+#endif // MODEL_LAUNCHSERVICE_H
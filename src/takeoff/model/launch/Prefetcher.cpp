@@ -0,0 +1,329 @@
+/**
+ * @file /src/takeoff/model/launch/Prefetcher.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  Prefetcher
+ */
+#include "Prefetcher.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#endif
+#include <QtCore/QByteArray>
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QRunnable>
+#include <QtCore/QSet>
+#include <QtCore/QThreadPool>
+#include <KDE/KSaveFile>
+#include <KDE/KStandardDirs>
+#include "LaunchService.h"
+#include "../config/Config.h"
+#include "../history/LaunchHistory.h"
+
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/**
+ * Indicates if a path is a regular file, without opening it. The devices and
+ * FIFOs mapped by some applications must not be opened.
+ * @param  path The encoded path.
+ * @return If it is a regular file.
+ */
+bool isRegularFile(const QByteArray &path)
+{
+    struct stat info;
+    return ::stat(path.constData(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+/**
+ * Opens a file to read it without blocking and, when the user owns the file,
+ * without updating its access time.
+ * @param  path The encoded path.
+ * @return The file descriptor or -1 on error.
+ */
+int openForPrefetch(const QByteArray &path)
+{
+    int flags = O_RDONLY | O_NONBLOCK;
+#ifdef O_NOATIME
+    int fd = ::open(path.constData(), flags | O_NOATIME);
+    if (fd != -1 || errno != EPERM)
+        return fd;
+#endif
+    return ::open(path.constData(), flags);
+}
+
+/**
+ * Sets the idle CPU and I/O priority to the calling thread, so the prefetch
+ * only uses the disk when nothing else needs it.
+ */
+void setIdlePriority()
+{
+#ifdef Q_OS_LINUX
+    // On Linux the nice value and the I/O priority are per thread
+    const int IOPRIO_CLASS_IDLE   = 3;
+    const int IOPRIO_CLASS_SHIFT  = 13;
+    const int IOPRIO_WHO_PROCESS  = 1;
+    pid_t tid = ::syscall(SYS_gettid);
+    ::setpriority(PRIO_PROCESS, tid, 19);
+    ::syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, tid,
+            IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT);
+#endif
+}
+
+/**
+ * Asks the kernel to read the files in advance.
+ */
+class PrefetchJob : public QRunnable
+{
+public:
+    PrefetchJob(const QStringList &files, qint64 byteBudget, int fileBudget,
+            QAtomicInt *running)
+            : files(files),
+              byteBudget(byteBudget),
+              fileBudget(fileBudget),
+              running(running)
+    {
+
+    }
+
+    virtual void run()
+    {
+        setIdlePriority();
+
+        qint64 bytes = 0;
+        for (int n=0; n<this->files.length() && n<this->fileBudget
+                && bytes<this->byteBudget; n++) {
+            // The lists saved by older versions may contain devices
+            QByteArray path = QFile::encodeName(this->files.at(n));
+            if (!isRegularFile(path))
+                continue;
+
+            int fd = openForPrefetch(path);
+            if (fd == -1)
+                continue;
+
+            struct stat info;
+            if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+                off_t length = qMin(qint64(info.st_size),
+                        this->byteBudget - bytes);
+                ::posix_fadvise(fd, 0, length, POSIX_FADV_WILLNEED);
+                bytes += length;
+            }
+
+            ::close(fd);
+        }
+
+        this->running->fetchAndStoreOrdered(0);
+    }
+
+private:
+    QStringList files;
+    qint64 byteBudget;
+    int fileBudget;
+    QAtomicInt *running;
+};
+
+/**
+ * Writes the known files of each application.
+ */
+class SaveJob : public QRunnable
+{
+public:
+    SaveJob(const QString &path, const QHash<QString, QStringList> &files)
+            : path(path),
+              files(files)
+    {
+
+    }
+
+    virtual void run()
+    {
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out << this->files;
+
+        KSaveFile file(this->path);
+        if (!file.open() || file.write(data) != data.size()) {
+            file.abort();
+            return;
+        }
+        file.finalize();
+    }
+
+private:
+    QString path;
+    QHash<QString, QStringList> files;
+};
+
+}
+
+
+// ************************************************************************** //
+// **********             STATIC METHODS AND VARIABLES             ********** //
+// ************************************************************************** //
+
+Prefetcher *Prefetcher::instance = NULL;
+
+Prefetcher *Prefetcher::getInstance()
+{
+    if (Prefetcher::instance == NULL) {
+        Prefetcher::instance = new Prefetcher();
+        Prefetcher::instance->load();
+    }
+
+    return Prefetcher::instance;
+}
+
+QStringList Prefetcher::getMappedFiles(qint64 pid)
+{
+    QFile maps(QString("/proc/%1/maps").arg(pid));
+    if (!maps.open(QIODevice::ReadOnly))
+        return QStringList();
+
+    // Each line is "address perms offset dev inode path", the path starts at
+    // the first '/' and the deleted files end with " (deleted)"
+    QStringList ret;
+    QSet<QString> seen;
+    foreach (const QByteArray &line, maps.readAll().split('\n')) {
+        int slash = line.indexOf('/');
+        if (slash == -1 || line.endsWith(" (deleted)"))
+            continue;
+
+        // The devices, like /dev/dri/card0, are mapped by some applications
+        QByteArray encoded = line.mid(slash);
+        QString path = QFile::decodeName(encoded);
+        if (!seen.contains(path)) {
+            seen.insert(path);
+            if (isRegularFile(encoded))
+                ret.append(path);
+        }
+    }
+
+    return ret;
+}
+
+QString Prefetcher::getFilesPath()
+{
+    return KStandardDirs::locateLocal("cache", "takeoff/prefetch", true);
+}
+
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+Prefetcher::Prefetcher()
+        : running(0),
+          pool(new QThreadPool)
+{
+    this->pool->setMaxThreadCount(1);
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC METHODS                    ********** //
+// ************************************************************************** //
+
+void Prefetcher::prefetch()
+{
+    if (!Config::getInstance()->getValues().prefetchApplications)
+        return;
+
+    QDateTime now = QDateTime::currentDateTime();
+    if (this->lastPrefetch.isValid()
+            && this->lastPrefetch.secsTo(now) < MIN_INTERVAL)
+        return;
+
+    if (!this->running.testAndSetOrdered(0, 1))
+        return;
+    this->lastPrefetch = now;
+
+    // The files of the most used application first, so the budget is spent in
+    // the applications more likely to be launched
+    QStringList paths;
+    QSet<QString> seen;
+    QStringList mostUsed =
+            LaunchHistory::getInstance()->getMostUsed(NUM_APPLICATIONS);
+    foreach (const QString &desktopFile, mostUsed) {
+        QStringList appFiles = this->files.value(desktopFile);
+        if (appFiles.isEmpty()) {
+            QString executable =
+                    LaunchService::getInstance()->getExecutable(desktopFile);
+            if (!executable.isEmpty())
+                appFiles.append(executable);
+        }
+
+        foreach (const QString &path, appFiles) {
+            if (!seen.contains(path)) {
+                seen.insert(path);
+                paths.append(path);
+            }
+        }
+    }
+
+    this->pool->start(new PrefetchJob(paths, BYTE_BUDGET, FILE_BUDGET,
+            &this->running));
+}
+
+void Prefetcher::setFiles(const QString &desktopFile, const QStringList &files)
+{
+    if (files.isEmpty() || this->files.value(desktopFile) == files)
+        return;
+
+    this->files.insert(desktopFile, files);
+
+    // Forget the applications that are not used anymore
+    QStringList mostUsed =
+            LaunchHistory::getInstance()->getMostUsed(NUM_APPLICATIONS * 4);
+    QHash<QString, QStringList> kept;
+    foreach (const QString &app, mostUsed) {
+        if (this->files.contains(app))
+            kept.insert(app, this->files.value(app));
+    }
+    kept.insert(desktopFile, files);
+    this->files = kept;
+
+    this->pool->start(new SaveJob(getFilesPath(), this->files));
+}
+
+
+// ************************************************************************** //
+// **********                   PRIVATE METHODS                    ********** //
+// ************************************************************************** //
+
+void Prefetcher::load()
+{
+    QFile file(getFilesPath());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QByteArray data = file.readAll();
+    QDataStream in(data);
+    QHash<QString, QStringList> files;
+    in >> files;
+    if (in.status() == QDataStream::Ok)
+        this->files = files;
+}
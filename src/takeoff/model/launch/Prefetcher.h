@@ -0,0 +1,119 @@
+/**
+ * @file /src/takeoff/model/launch/Prefetcher.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  Prefetcher
+ */
+#ifndef MODEL_PREFETCHER_H
+#define MODEL_PREFETCHER_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QDateTime>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+class QThreadPool;
+
+/**
+ * Asks the kernel to read in advance the files of the most used applications,
+ * so they start faster if they were evicted from the page cache. The files of
+ * each application are the files it had mapped in memory the last time it was
+ * launched, or only its executable if they are not known yet.
+ *
+ * The files are read with posix_fadvise(WILLNEED) from a thread with idle CPU
+ * and I/O priority, with a limit of bytes and files per prefetch.
+ */
+class Prefetcher
+{
+
+public:
+
+    /**
+     * Only method to get an instance of the class. The known files are loaded
+     * the first time.
+     * @return The single instance of the class.
+     */
+    static Prefetcher *getInstance();
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Prefetches the files of the most used applications, if it is enabled in
+     * the configuration and the last prefetch was not too recent.
+     */
+    void prefetch();
+
+    /**
+     * Sets the files used by an application.
+     * @param desktopFile The desktop file of the application.
+     * @param files       The absolute paths of the files.
+     */
+    void setFiles(const QString &desktopFile, const QStringList &files);
+
+    /**
+     * Returns the regular files mapped in memory by a process.
+     * @param  pid The process.
+     * @return The absolute paths of the files, empty if the process doesn't
+     *         exist.
+     */
+    static QStringList getMappedFiles(qint64 pid);
+
+private:
+
+    /// Returns the path of the file with the known files of each application.
+    static QString getFilesPath();
+
+    /// Reads the known files of each application.
+    void load();
+
+    //--------------------------------------------------------------------------
+
+    /// Number of applications to prefetch.
+    static const int NUM_APPLICATIONS = 8;
+
+    /// Maximum number of bytes to prefetch each time.
+    static const qint64 BYTE_BUDGET = Q_INT64_C(256) * 1024 * 1024;
+
+    /// Maximum number of files to prefetch each time.
+    static const int FILE_BUDGET = 1024;
+
+    /// Minimum time between two prefetches, in seconds.
+    static const int MIN_INTERVAL = 10 * 60;
+
+    /// Known files of each application, by desktop file.
+    QHash<QString, QStringList> files;
+
+    /// Time of the last prefetch.
+    QDateTime lastPrefetch;
+
+    /// Set while a prefetch job is running.
+    QAtomicInt running;
+
+    /// Thread where the files are prefetched and written.
+    QThreadPool *pool;
+
+    /// Single instance of the class.
+    static Prefetcher *instance;
+
+    // Hide constructors
+    Prefetcher();
+    Prefetcher(const Prefetcher&);
+    const Prefetcher &operator = (const Prefetcher&);
+
+};
+
+#endif // MODEL_PREFETCHER_H
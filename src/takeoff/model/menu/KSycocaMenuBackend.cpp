@@ -0,0 +1,143 @@
+/**
+ * @file /src/takeoff/model/menu/KSycocaMenuBackend.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  KSycocaMenuBackend
+ */
+#include "KSycocaMenuBackend.h"
+#include <QtCore/QDir>
+#include <QtXml/QDomElement>
+#include <KDE/KService>
+#include <KDE/KStandardDirs>
+#include <KDE/KSycoca>
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+KSycocaMenuBackend::KSycocaMenuBackend()
+        : outDated(false)
+{
+    connect(KSycoca::self(), SIGNAL(databaseChanged(QStringList)),
+            this, SLOT(databaseChanged(QStringList)));
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC METHODS                    ********** //
+// ************************************************************************** //
+
+QDomDocument KSycocaMenuBackend::getXml() const
+{
+    return this->xml;
+}
+
+void KSycocaMenuBackend::unload()
+{
+    this->xml = QDomDocument();
+}
+
+bool KSycocaMenuBackend::isOutDated() const
+{
+    return this->outDated;
+}
+
+MenuBackend::Type KSycocaMenuBackend::getType() const
+{
+    return KSYCOCA;
+}
+
+
+// ************************************************************************** //
+// **********                  PROTECTED METHODS                   ********** //
+// ************************************************************************** //
+
+bool KSycocaMenuBackend::load()
+{
+    // The database doesn't exist until kbuildsycoca4 is run
+    KServiceGroup::Ptr root = KServiceGroup::root();
+    if (!KSycoca::isAvailable() || root.isNull() || !root->isValid())
+        return false;
+
+    this->xml = QDomDocument();
+    QDomElement rootMenu = this->xml.createElement("Menu");
+    this->xml.appendChild(rootMenu);
+    this->addEntries(root, rootMenu);
+    this->outDated = false;
+    return true;
+}
+
+
+// ************************************************************************** //
+// **********                    PRIVATE SLOTS                     ********** //
+// ************************************************************************** //
+
+void KSycocaMenuBackend::databaseChanged(const QStringList &changedResources)
+{
+    if (changedResources.contains("apps")
+            || changedResources.contains("xdgdata-apps"))
+        this->outDated = true;
+}
+
+
+// ************************************************************************** //
+// **********                   PRIVATE METHODS                    ********** //
+// ************************************************************************** //
+
+void KSycocaMenuBackend::addEntries(KServiceGroup::Ptr group, QDomElement &menu)
+{
+    KServiceGroup::List entries = group->entries(true, true, false, false);
+    foreach (const KSycocaEntry::Ptr &entry, entries) {
+        if (entry->isType(KST_KServiceGroup)) {
+            KServiceGroup::Ptr subgroup =
+                    KServiceGroup::Ptr::staticCast(entry);
+            if (subgroup->noDisplay() || subgroup->childCount() == 0)
+                continue;
+
+            QDomElement submenu = this->xml.createElement("Menu");
+            submenu.setAttribute("title", subgroup->caption());
+            submenu.setAttribute("icon", subgroup->icon());
+            this->addEntries(subgroup, submenu);
+            menu.appendChild(submenu);
+
+        } else if (entry->isType(KST_KService)) {
+            KService::Ptr service = KService::Ptr::staticCast(entry);
+            if (service->noDisplay())
+                continue;
+
+            // The paths of the applications are relative to their directory
+            QString desktopFile = service->entryPath();
+            if (QDir::isRelativePath(desktopFile))
+                desktopFile = KStandardDirs::locate("xdgdata-apps",
+                        desktopFile);
+
+            // Same attributes as XdgMenuApplinkProcessor::fillAppLink()
+            QDomElement appLink = this->xml.createElement("AppLink");
+            appLink.setAttribute("id", service->menuId());
+            appLink.setAttribute("title", service->name());
+            appLink.setAttribute("comment", service->comment());
+            appLink.setAttribute("genericName", service->genericName());
+            appLink.setAttribute("keywords", service->keywords().join(";"));
+            appLink.setAttribute("exec", service->exec());
+            appLink.setAttribute("terminal", service->terminal());
+            appLink.setAttribute("path", service->path());
+            appLink.setAttribute("icon", service->icon());
+            appLink.setAttribute("desktopFile", desktopFile);
+            menu.appendChild(appLink);
+        }
+    }
+}
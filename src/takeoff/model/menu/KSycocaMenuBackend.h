@@ -0,0 +1,85 @@
+/**
+ * @file /src/takeoff/model/menu/KSycocaMenuBackend.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  KSycocaMenuBackend
+ */
+#ifndef MODEL_KSYCOCAMENUBACKEND_H
+#define MODEL_KSYCOCAMENUBACKEND_H
+
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+#include <KDE/KServiceGroup>
+#include "MenuBackend.h"
+class QDomElement;
+
+/**
+ * Backend that reads the menu from KSycoca, the binary database of services
+ * that kbuildsycoca4 keeps updated and that every KDE application maps in
+ * memory. The menu files are not parsed, but the menu is only as recent as
+ * the database.
+ */
+class KSycocaMenuBackend : public QObject, public MenuBackend
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    KSycocaMenuBackend();
+
+    //--------------------------------------------------------------------------
+
+    virtual QDomDocument getXml() const;
+    virtual void unload();
+    virtual bool isOutDated() const;
+    virtual Type getType() const;
+
+protected:
+
+    virtual bool load();
+
+private slots:
+
+    /**
+     * Marks the menu as outdated when the applications of the database change.
+     * @param changedResources The resources that have changed.
+     */
+    void databaseChanged(const QStringList &changedResources);
+
+private:
+
+    /**
+     * Adds the entries of a group of the database to a menu element.
+     * @param group The group.
+     * @param menu  The element where the entries are added.
+     */
+    void addEntries(KServiceGroup::Ptr group, QDomElement &menu);
+
+    //--------------------------------------------------------------------------
+
+    /// The menu.
+    QDomDocument xml;
+
+    /// If the database has changed since the menu was loaded.
+    bool outDated;
+
+};
+
+#endif // MODEL_KSYCOCAMENUBACKEND_H
@@ -19,8 +19,15 @@
  * @class  Menu
  */
 #include "Menu.h"
+#include <QtXml/QDomDocument>
 #include <KDE/KIcon>
-#include "qtxdg/xdgmenu.h"
+#include "MenuBackend.h"
+#include "../config/Config.h"
+#include "../icons/SharedIconEngine.h"
+#include "../launch/LaunchService.h"
+#include "../search/SearchIndex.h"
+#include "../../metrics/Metrics.h"
+#include "../../trace/Trace.h"
 
 // ************************************************************************** //
 // **********             STATIC METHODS AND VARIABLES             ********** //
@@ -43,6 +50,21 @@ void Menu::loadMenu()
         instance = NULL;
     }
     Menu::getInstance();
+
+    // The desktop files could have changed
+    LaunchService::getInstance()->clear();
+}
+
+bool Menu::loadMenuIfOutDated()
+{
+    if (instance != NULL && !instance->backend->isOutDated()) {
+        Metrics::add(Metrics::MENU_CACHE_HITS);
+        return false;
+    }
+
+    Metrics::add(Metrics::MENU_CACHE_MISSES);
+    Menu::loadMenu();
+    return true;
 }
 
 
@@ -54,17 +76,29 @@ void Menu::loadMenu()
 Menu::Menu()
         : allApplications(new QList<Takeoff::Launcher*>),
           categories(new QList< QPair<QString, KIcon>* >),
-          categoriesApplications(new QList< QList<Takeoff::Launcher*>* >)
+          categoriesApplications(new QList< QList<Takeoff::Launcher*>* >),
+          searchIndex(new SearchIndex),
+          backend(NULL)
 {
-    QString menuFile = XdgMenu::getMenuFileName();
-    XdgMenu xdgMenu;
-    xdgMenu.environments() << "KDE";
-
-    bool res = xdgMenu.read(menuFile);
+    TAKEOFF_TRACE_SPAN("Menu::Menu");
+
+    int type = Config::getInstance()->getValues().menuBackend;
+    if (type < 0 || type >= MenuBackend::NUM_TYPES)
+        type = MenuBackend::XDG;
+    this->backend = MenuBackend::create((MenuBackend::Type)type);
+    bool res = this->backend->read();
+
+    // KSycoca is not available until kbuildsycoca4 is run
+    if (!res && type != MenuBackend::XDG) {
+        delete this->backend;
+        this->backend = MenuBackend::create(MenuBackend::XDG);
+        res = this->backend->read();
+    }
     if (!res)
         qFatal("Error loading xdg-menu");
 
-    QDomNode rootNode = xdgMenu.xml().firstChild();
+    TAKEOFF_TRACE_SPAN("Menu::saveApplications");
+    QDomNode rootNode = this->backend->getXml().firstChild();
     QDomNode categorieNode = rootNode.firstChild();
 
     for (categorieNode.firstChild(); !categorieNode.isNull();
@@ -87,10 +121,17 @@ Menu::Menu()
             this->categoriesApplications->append(l);
 
             // Save the category applications
+            int first = this->allApplications->length();
             this->saveApplications(categorieNode.firstChild(),
                     this->categories->length()-1);
+            this->categoriesRanges.append(qMakePair(first,
+                    this->allApplications->length() - first));
         }
     }
+
+    // Only the launchers are kept, the menu is only watched
+    this->backend->unload();
+    this->searchIndex->squeeze();
 }
 
 Menu::~Menu()
@@ -99,6 +140,7 @@ Menu::~Menu()
     delete this->allApplications;
     delete this->categories;
     delete this->categoriesApplications;
+    delete this->backend;
 }
 
 
@@ -113,16 +155,33 @@ void Menu::saveApplications(QDomNode node, int categoryIndex)
         if(elem.isNull())
             continue;
 
-        // Launcher
+        // Launcher. Its icon is shared with the other sessions of the host
         if(elem.tagName() == "AppLink") {
             Takeoff::Launcher* launcher = new Takeoff::Launcher(
-                    KIcon(elem.attribute("icon")),
+                    QIcon(new SharedIconEngine(elem.attribute("icon"))),
                     elem.attribute("title"),
                     elem.attribute("desktopFile"));
 
             this->allApplications->append(launcher);
             this->categoriesApplications->at(categoryIndex)->append(launcher);
 
+            // Index the application only once, although it appears in more
+            // than one category
+            QString desktopFile = elem.attribute("desktopFile");
+            if (!this->desktopFilesIndex.contains(desktopFile)) {
+                int id = this->allApplications->length()-1;
+                this->desktopFilesIndex.insert(desktopFile, id);
+
+                QString fields[SearchIndex::NUM_FIELDS];
+                fields[SearchIndex::NAME]     = elem.attribute("title");
+                fields[SearchIndex::KEYWORDS] = elem.attribute("keywords");
+                fields[SearchIndex::COMMENT]  = elem.attribute("comment");
+                fields[SearchIndex::EXEC]     = elem.attribute("exec");
+                fields[SearchIndex::GENERIC_NAME] =
+                        elem.attribute("genericName");
+                this->searchIndex->addApplication(id, fields);
+            }
+
         // Submenu
         } else {
             this->saveApplications(node.firstChild(), categoryIndex);
@@ -150,3 +209,18 @@ QList<Takeoff::Launcher*> *Menu::getCategoriesApplications(int categoryIndex)
 {
     return this->categoriesApplications->at(categoryIndex);
 }
+
+QPair<int, int> Menu::getCategoryRange(int categoryIndex) const
+{
+    return this->categoriesRanges.at(categoryIndex);
+}
+
+QSharedPointer<SearchIndex> Menu::getSearchIndex() const
+{
+    return this->searchIndex;
+}
+
+int Menu::getApplicationIndex(const QString &desktopFile) const
+{
+    return this->desktopFilesIndex.value(desktopFile, -1);
+}
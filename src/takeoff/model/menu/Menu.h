@@ -23,12 +23,17 @@
 
 #include <QtCore/QList>
 #include <QtCore/QPair>
+#include <QtCore/QHash>
+#include <QtCore/QSharedPointer>
 #include "../../takeoff_widget/Launcher.h"
 class QDomNode;
 class KIcon;
+class MenuBackend;
+class SearchIndex;
 
 /**
- * Class to access to the xdg-menu standard.
+ * Class to access to the menu of applications. The menu is read by the
+ * MenuBackend selected in the configuration.
  */
 class Menu
 {
@@ -46,6 +51,12 @@ public:
      */
     static void loadMenu();
 
+    /**
+     * Reloads the menu only if any of its files has changed since it was read.
+     * @return If the menu was reloaded.
+     */
+    static bool loadMenuIfOutDated();
+
     /**
      * Destructor.
      */
@@ -75,6 +86,32 @@ public:
     QList<Takeoff::Launcher*> *getCategoriesApplications(int categoryIndex)
             const;
 
+    /**
+     * Returns the position of the applications of the specified category in
+     * the getAllApplications() list, where they are consecutive.
+     * @param  categoryIndex The position of the category in the getCategories()
+     *         list.
+     * @return The position of the first application and the number of
+     *         applications.
+     */
+    QPair<int, int> getCategoryRange(int categoryIndex) const;
+
+    /**
+     * Returns the index used to search applications. The identifiers of the
+     * index are positions in the getAllApplications() list. The index is shared
+     * to allow searching in other thread while the menu is reloaded.
+     * @return The index.
+     */
+    QSharedPointer<SearchIndex> getSearchIndex() const;
+
+    /**
+     * Returns the position of the specified application in the
+     * getAllApplications() list.
+     * @param  desktopFile The desktop file of the application.
+     * @return The position or -1 if the application is not in the menu.
+     */
+    int getApplicationIndex(const QString &desktopFile) const;
+
 private:
 
     /**
@@ -96,6 +133,18 @@ private:
     /// List with all applications belonging to one category.
     QList< QList<Takeoff::Launcher*>* > *categoriesApplications;
 
+    /// First application and number of applications of each category.
+    QList< QPair<int, int> > categoriesRanges;
+
+    /// Position in allApplications of the first launcher of each desktop file.
+    QHash<QString, int> desktopFilesIndex;
+
+    /// Index of the searchable fields of the applications.
+    QSharedPointer<SearchIndex> searchIndex;
+
+    /// The source of the menu, kept to watch its changes.
+    MenuBackend *backend;
+
     //--------------------------------------------------------------------------
 
     /// Single instance of the class.
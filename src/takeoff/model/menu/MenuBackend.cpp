@@ -0,0 +1,83 @@
+/**
+ * @file /src/takeoff/model/menu/MenuBackend.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  MenuBackend
+ */
+#include "MenuBackend.h"
+#include <QtCore/QElapsedTimer>
+#include "KSycocaMenuBackend.h"
+#include "XdgMenuBackend.h"
+#include "../../metrics/Metrics.h"
+#include "../../trace/Trace.h"
+
+// ************************************************************************** //
+// **********             STATIC METHODS AND VARIABLES             ********** //
+// ************************************************************************** //
+
+bool MenuBackend::loadedBefore[MenuBackend::NUM_TYPES] = { false, false };
+
+MenuBackend *MenuBackend::create(Type type)
+{
+    if (type == KSYCOCA)
+        return new KSycocaMenuBackend;
+
+    return new XdgMenuBackend;
+}
+
+
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+MenuBackend::~MenuBackend()
+{
+
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC METHODS                    ********** //
+// ************************************************************************** //
+
+bool MenuBackend::read()
+{
+    Type type = this->getType();
+    TAKEOFF_TRACE_SPAN(type == KSYCOCA ? "MenuBackend::read(ksycoca)"
+            : "MenuBackend::read(xdg)");
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!this->load())
+        return false;
+    qint64 elapsed = timer.nsecsElapsed() / 1000;
+
+    // The first load of the process fills the caches of the backend. The page
+    // cache of the system could be warm anyway, so it is not a cold load
+    bool first = !MenuBackend::loadedBefore[type];
+    MenuBackend::loadedBefore[type] = true;
+    if (type == KSYCOCA) {
+        Metrics::record(first ? Metrics::KSYCOCA_MENU_FIRST_LOAD
+                : Metrics::KSYCOCA_MENU_REPEATED_LOAD, elapsed);
+    } else {
+        Metrics::record(first ? Metrics::XDG_MENU_FIRST_LOAD
+                : Metrics::XDG_MENU_REPEATED_LOAD, elapsed);
+    }
+
+    return true;
+}
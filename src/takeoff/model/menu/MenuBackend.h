@@ -0,0 +1,106 @@
+/**
+ * @file /src/takeoff/model/menu/MenuBackend.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  MenuBackend
+ */
+#ifndef MODEL_MENUBACKEND_H
+#define MODEL_MENUBACKEND_H
+
+#include <QtXml/QDomDocument>
+
+/**
+ * Source of the categories and applications of the menu. Every backend returns
+ * the menu with the format of XdgMenu::xml(): nested "Menu" elements, with a
+ * title and an icon, that contain the "AppLink" elements of the applications.
+ *
+ * The loads are timed: the first load of each backend in the process and the
+ * repeated ones are recorded apart, so the backends can be compared with
+ * takeoff-menubench and the metrics dump.
+ */
+class MenuBackend
+{
+
+public:
+
+    /// Available backends, the value is saved in the configuration.
+    enum Type {
+        XDG,
+        KSYCOCA,
+        NUM_TYPES
+    };
+
+    /**
+     * Creates a backend. The menu is not loaded.
+     * @param  type The backend.
+     * @return The backend, owned by the caller.
+     */
+    static MenuBackend *create(Type type);
+
+    /**
+     * Destructor.
+     */
+    virtual ~MenuBackend();
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Loads the menu and records how long it took.
+     * @return If the menu was loaded.
+     */
+    bool read();
+
+    /**
+     * Returns the loaded menu.
+     * @return The menu.
+     */
+    virtual QDomDocument getXml() const = 0;
+
+    /**
+     * Frees the loaded menu once it has been read. The backend keeps watching
+     * the menu, see isOutDated().
+     */
+    virtual void unload() = 0;
+
+    /**
+     * Indicates if the menu has changed since it was loaded.
+     * @return If the menu must be loaded again.
+     */
+    virtual bool isOutDated() const = 0;
+
+    /**
+     * Returns the type of the backend.
+     * @return The type.
+     */
+    virtual Type getType() const = 0;
+
+protected:
+
+    /**
+     * Loads the menu.
+     * @return If the menu was loaded.
+     */
+    virtual bool load() = 0;
+
+private:
+
+    /// If each backend was already loaded in this process.
+    static bool loadedBefore[NUM_TYPES];
+
+};
+
+#endif // MODEL_MENUBACKEND_H
@@ -0,0 +1,318 @@
+/**
+ * @file /src/takeoff/model/menu/SharedMenu.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  SharedMenu
+ */
+#include "SharedMenu.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtNetwork/QLocalSocket>
+#include <QtXml/QDomDocument>
+#include <QtXml/QDomElement>
+#include <QtXml/QDomNodeList>
+#include "qtxdg/xdgdesktopfile.h"
+#include "qtxdg/xdgdirs.h"
+#include "qtxdg/xdgmenu.h"
+#include "qtxdg/xdgmenuapplinkprocessor.h"
+#include "../../metrics/Metrics.h"
+#include "../../trace/Trace.h"
+
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/// Indicates if a directory contains files with the extension, recursively.
+bool containsFiles(const QString &dirName, const QString &extension)
+{
+    QDir dir(dirName);
+    if (!dir.exists())
+        return false;
+
+    if (!dir.entryList(QStringList("*" + extension), QDir::Files).isEmpty())
+        return true;
+
+    foreach (const QString &subdir,
+            dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        if (containsFiles(dir.filePath(subdir), extension))
+            return true;
+    }
+
+    return false;
+}
+
+/// Indicates if an element contains entries or submenus.
+bool hasEntries(const QDomElement &menu)
+{
+    for (QDomElement e = menu.firstChildElement(); !e.isNull();
+            e = e.nextSiblingElement()) {
+        if (e.tagName() == "AppLink" || e.tagName() == "Menu")
+            return true;
+    }
+
+    return false;
+}
+
+}
+
+
+// ************************************************************************** //
+// **********             STATIC METHODS AND VARIABLES             ********** //
+// ************************************************************************** //
+
+bool SharedMenu::read(XdgMenu *menu, const QString &menuFile)
+{
+    TAKEOFF_TRACE_SPAN("SharedMenu::read");
+
+    if (menuFile.isEmpty() || hasUserMenu()) {
+        Metrics::add(Metrics::SHARED_MENU_FALLBACKS);
+        return false;
+    }
+
+    QHash<QString, QString> userFiles;
+    QStringList userDirs;
+    findUserFiles(XdgDirs::dataHome(false) + "/applications", "", &userFiles,
+            &userDirs);
+
+    QByteArray xml;
+    QStringList watchPaths;
+    if (!requestSnapshot(menu, menuFile, &xml, &watchPaths)
+            || !menu->readResolved(menuFile, xml, watchPaths + userDirs)
+            || !applyUserFiles(menu, userFiles)) {
+        Metrics::add(Metrics::SHARED_MENU_FALLBACKS);
+        return false;
+    }
+
+    Metrics::add(Metrics::SHARED_MENU_HITS);
+    return true;
+}
+
+QString SharedMenu::getSocketPath()
+{
+    QString path = QFile::decodeName(::getenv("TAKEOFF_MENUD_SOCKET"));
+    return path.isEmpty() ? QString("/run/takeoff-menud.socket") : path;
+}
+
+QByteArray SharedMenu::frame(const QByteArray &payload)
+{
+    QByteArray ret;
+    QDataStream out(&ret, QIODevice::WriteOnly);
+    out << quint32(payload.size());
+    ret.append(payload);
+    return ret;
+}
+
+bool SharedMenu::takeFrame(QIODevice *device, QByteArray *payload)
+{
+    QByteArray sizeBytes = device->peek(sizeof(quint32));
+    if (sizeBytes.size() < (int)sizeof(quint32))
+        return false;
+
+    quint32 size;
+    QDataStream in(sizeBytes);
+    in >> size;
+    if (size > (quint32)MAX_FRAME_SIZE) {
+        device->close();
+        return false;
+    }
+    if (device->bytesAvailable() < qint64(sizeof(quint32) + size))
+        return false;
+
+    device->read(sizeof(quint32));
+    *payload = device->read(size);
+    return true;
+}
+
+bool SharedMenu::hasUserMenu()
+{
+    // The user menu files are merged by XdgMenuReader and the directory files
+    // change the names of the categories
+    return containsFiles(XdgDirs::configHome(false) + "/menus", ".menu")
+            || containsFiles(XdgDirs::dataHome(false)
+                    + "/desktop-directories", ".directory");
+}
+
+void SharedMenu::findUserFiles(const QString &dirName, const QString &prefix,
+        QHash<QString, QString> *files, QStringList *dirs)
+{
+    // Same ids as XdgMenuApplinkProcessor::findDesktopFiles()
+    QDir dir(dirName);
+    if (!dir.exists())
+        return;
+    dirs->append(dir.absolutePath());
+
+    foreach (const QFileInfo &file, dir.entryInfoList(
+            QStringList("*.desktop"), QDir::Files))
+        files->insert(prefix + file.fileName(), file.canonicalFilePath());
+
+    foreach (const QFileInfo &subdir, dir.entryInfoList(QStringList(),
+            QDir::Dirs | QDir::NoDotAndDotDot))
+        findUserFiles(subdir.canonicalFilePath(), subdir.fileName() + "-",
+                files, dirs);
+}
+
+bool SharedMenu::requestSnapshot(XdgMenu *menu, const QString &menuFile,
+        QByteArray *xml, QStringList *watchPaths)
+{
+    QLocalSocket socket;
+    socket.connectToServer(getSocketPath());
+    if (!socket.waitForConnected(CONNECT_TIMEOUT))
+        return false;
+
+    // Only trust a helper run by root or by the user, other users could
+    // publish a menu that starts their programs
+    struct ucred credentials;
+    socklen_t length = sizeof(credentials);
+    if (::getsockopt(socket.socketDescriptor(), SOL_SOCKET, SO_PEERCRED,
+            &credentials, &length) != 0
+            || (credentials.uid != 0 && credentials.uid != ::getuid()))
+        return false;
+
+    QByteArray request;
+    QDataStream out(&request, QIODevice::WriteOnly);
+    out << VERSION << menuFile << menu->language() << XdgDirs::dataDirs()
+            << XdgDirs::configDirs() << menu->environments();
+    socket.write(frame(request));
+
+    QElapsedTimer timer;
+    timer.start();
+    QByteArray answer;
+    while (!takeFrame(&socket, &answer)) {
+        int remaining = ANSWER_TIMEOUT - timer.elapsed();
+        if (remaining <= 0 || !socket.waitForReadyRead(remaining))
+            return false;
+    }
+
+    quint32 status;
+    QString name;
+    QDataStream in(answer);
+    in >> status >> name >> *watchPaths;
+    if (in.status() != QDataStream::Ok || status != OK)
+        return false;
+
+    return mapSnapshot(name, credentials.uid, xml);
+}
+
+bool SharedMenu::mapSnapshot(const QString &name, uid_t owner, QByteArray *xml)
+{
+    int fd = ::shm_open(QFile::encodeName(name).constData(), O_RDONLY, 0);
+    if (fd == -1)
+        return false;
+
+    // The object must be owned by the helper and not writable by others
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_uid != owner
+            || (info.st_mode & (S_IWGRP | S_IWOTH)) != 0
+            || info.st_size < (off_t)sizeof(SnapshotHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    void *data = ::mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    const SnapshotHeader *header = (const SnapshotHeader*)data;
+    bool valid = header->magic == MAGIC && header->version == VERSION
+            && header->size <= info.st_size - sizeof(SnapshotHeader);
+    if (valid)
+        *xml = QByteArray((const char*)(header + 1), header->size);
+
+    ::munmap(data, info.st_size);
+    return valid;
+}
+
+bool SharedMenu::applyUserFiles(XdgMenu *menu,
+        const QHash<QString, QString> &userFiles)
+{
+    if (userFiles.isEmpty())
+        return true;
+
+    // The document is shared, the changes are done in the menu
+    QDomDocument xml = menu->xml();
+    QHash<QString, QList<QDomElement> > appLinks;
+    QDomNodeList nodes = xml.elementsByTagName("AppLink");
+    for (int n=0; n<nodes.count(); n++) {
+        QDomElement appLink = nodes.at(n).toElement();
+        appLinks[appLink.attribute("id")].append(appLink);
+    }
+
+    QHashIterator<QString, QString> it(userFiles);
+    while (it.hasNext()) {
+        it.next();
+        XdgDesktopFile *file = XdgDesktopFileCache::getFile(it.value());
+        if (file == NULL || !file->isValid())
+            return false;
+
+        bool displayed = XdgMenuApplinkProcessor::isDisplayed(*file,
+                menu->environments());
+        QList<QDomElement> elements = appLinks.value(it.key());
+
+        // A new entry is placed by the rules of the menu, that are not in the
+        // snapshot. The hidden ones are not placed at all
+        if (elements.isEmpty()) {
+            if (displayed)
+                return false;
+            continue;
+        }
+
+        // The rules only check the categories and the id, so the entry keeps
+        // the place of the system one if the categories are the same
+        XdgDesktopFile *system = XdgDesktopFileCache::getFile(
+                elements.first().attribute("desktopFile"));
+        if (system == NULL || system->value("Categories").toString()
+                != file->value("Categories").toString())
+            return false;
+
+        foreach (QDomElement appLink, elements) {
+            if (displayed)
+                XdgMenuApplinkProcessor::fillAppLink(appLink, it.key(), *file,
+                        menu->language());
+            else
+                removeAppLink(appLink);
+        }
+    }
+
+    return true;
+}
+
+void SharedMenu::removeAppLink(QDomElement appLink)
+{
+    QDomElement parent = appLink.parentNode().toElement();
+    parent.removeChild(appLink);
+
+    // Same as XdgMenuPrivate::deleteEmpty(), but the root is kept
+    while (!parent.isNull() && parent.tagName() == "Menu"
+            && !hasEntries(parent)
+            && parent != parent.ownerDocument().documentElement()) {
+        QDomElement grandParent = parent.parentNode().toElement();
+        grandParent.removeChild(parent);
+        parent = grandParent;
+    }
+}
@@ -0,0 +1,175 @@
+/**
+ * @file /src/takeoff/model/menu/SharedMenu.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  SharedMenu
+ */
+#ifndef MODEL_SHAREDMENU_H
+#define MODEL_SHAREDMENU_H
+
+#include <sys/types.h>
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+class QIODevice;
+class QDomElement;
+class XdgMenu;
+
+/**
+ * Reads the system part of the menu from takeoff-menud, a helper process that
+ * resolves it once for all the sessions of the host, and applies the desktop
+ * files of the user in-process.
+ *
+ * The helper publishes each resolved menu as a read-only POSIX shared memory
+ * object and answers the requests through a Unix socket, that only the users
+ * of the group given to the helper can open. Only the menus that the user
+ * doesn't customize can be shared: if the user has their own menu files, or a
+ * desktop file that would need the menu rules to be placed, the menu is
+ * resolved in-process as always. The same happens when the helper is not
+ * running or the user is not in its group.
+ */
+class SharedMenu
+{
+
+public:
+
+    /**
+     * Reads the menu from the helper and applies the desktop files of the user.
+     * @param  menu     The menu to fill, with its environments and language
+     *                  already set.
+     * @param  menuFile The menu file, see XdgMenu::getMenuFileName().
+     * @return If the menu was read. If not, it must be read with XdgMenu::read.
+     */
+    static bool read(XdgMenu *menu, const QString &menuFile);
+
+    /**
+     * Returns the path of the socket of the helper, TAKEOFF_MENUD_SOCKET or a
+     * fixed path in /run.
+     * @return The path.
+     */
+    static QString getSocketPath();
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Returns a message ready to be sent through the socket: its size followed
+     * by the data.
+     * @param  payload The data of the message.
+     * @return The message.
+     */
+    static QByteArray frame(const QByteArray &payload);
+
+    /**
+     * Reads a message sent with frame(), if it was completely received.
+     * @param  device  The socket.
+     * @param  payload The data of the message.
+     * @return If the message was read.
+     */
+    static bool takeFrame(QIODevice *device, QByteArray *payload);
+
+    //--------------------------------------------------------------------------
+
+    /// Answers of the helper.
+    enum Status {
+        OK,         ///< The menu is in the shared memory object
+        NOT_SERVED, ///< The helper doesn't share this menu
+        FAILED      ///< The menu couldn't be resolved
+    };
+
+    /// Start of the shared memory objects, followed by the XML of the menu.
+    struct SnapshotHeader {
+        quint32 magic;
+        quint32 version;
+        quint32 size;
+    };
+
+    /// First bytes of a snapshot.
+    static const quint32 MAGIC = 0x544B4D53;
+
+    /// Version of the protocol and of the snapshots.
+    static const quint32 VERSION = 1;
+
+    /// Maximum size of a message, to don't trust a wrong size.
+    static const int MAX_FRAME_SIZE = 64 * 1024;
+
+private:
+
+    /**
+     * Indicates if the user has menu files or directory files, that change the
+     * structure of the menu.
+     * @return If the menu of the user is not the system one.
+     */
+    static bool hasUserMenu();
+
+    /**
+     * Finds the desktop files of the user, with the same ids as the XdgMenu.
+     * @param dirName   The directory to search.
+     * @param prefix    The prefix of the ids in the directory.
+     * @param files     Path of each desktop file, by id.
+     * @param dirs      The searched directories, to watch them.
+     */
+    static void findUserFiles(const QString &dirName, const QString &prefix,
+            QHash<QString, QString> *files, QStringList *dirs);
+
+    /**
+     * Asks the helper for the menu and maps the snapshot.
+     * @param  menu     The menu, to send its environments.
+     * @param  menuFile The menu file.
+     * @param  xml      The XML of the menu.
+     * @param  watchPaths The paths to watch, from the helper.
+     * @return If the snapshot was read.
+     */
+    static bool requestSnapshot(XdgMenu *menu, const QString &menuFile,
+            QByteArray *xml, QStringList *watchPaths);
+
+    /**
+     * Copies the XML of a snapshot.
+     * @param  name  Name of the shared memory object.
+     * @param  owner User that must own the object, the user of the helper.
+     * @param  xml   The XML of the menu.
+     * @return If the snapshot is valid.
+     */
+    static bool mapSnapshot(const QString &name, uid_t owner, QByteArray *xml);
+
+    /**
+     * Replaces the entries of the system menu overridden by the user.
+     * @param  menu      The menu read from the snapshot.
+     * @param  userFiles The desktop files of the user, by id.
+     * @return False if an entry needs the menu rules, so the menu must be
+     *         resolved in-process.
+     */
+    static bool applyUserFiles(XdgMenu *menu,
+            const QHash<QString, QString> &userFiles);
+
+    /**
+     * Removes an entry and the menus that become empty.
+     * @param appLink The entry.
+     */
+    static void removeAppLink(QDomElement appLink);
+
+    //--------------------------------------------------------------------------
+
+    /// Milliseconds to wait for the connection.
+    static const int CONNECT_TIMEOUT = 100;
+
+    /// Milliseconds to wait for the answer, that can include the resolution.
+    static const int ANSWER_TIMEOUT = 5000;
+
+};
+
+#endif // MODEL_SHAREDMENU_H
@@ -0,0 +1,84 @@
+/**
+ * @file /src/takeoff/model/menu/XdgMenuBackend.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  XdgMenuBackend
+ */
+#include "XdgMenuBackend.h"
+#include "SharedMenu.h"
+#include "qtxdg/xdgmenu.h"
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+XdgMenuBackend::XdgMenuBackend()
+        : xdgMenu(new XdgMenu),
+          sharedMenuEnabled(true)
+{
+    this->xdgMenu->environments() << "KDE";
+}
+
+XdgMenuBackend::~XdgMenuBackend()
+{
+    delete this->xdgMenu;
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC METHODS                    ********** //
+// ************************************************************************** //
+
+QDomDocument XdgMenuBackend::getXml() const
+{
+    return this->xdgMenu->xml();
+}
+
+void XdgMenuBackend::unload()
+{
+    this->xdgMenu->unload();
+}
+
+bool XdgMenuBackend::isOutDated() const
+{
+    return this->xdgMenu->isOutDated();
+}
+
+MenuBackend::Type XdgMenuBackend::getType() const
+{
+    return XDG;
+}
+
+void XdgMenuBackend::setSharedMenuEnabled(bool enabled)
+{
+    this->sharedMenuEnabled = enabled;
+}
+
+
+// ************************************************************************** //
+// **********                  PROTECTED METHODS                   ********** //
+// ************************************************************************** //
+
+bool XdgMenuBackend::load()
+{
+    // The system menu is resolved by takeoff-menud if it is running
+    QString menuFile = XdgMenu::getMenuFileName();
+    if (this->sharedMenuEnabled && SharedMenu::read(this->xdgMenu, menuFile))
+        return true;
+
+    return this->xdgMenu->read(menuFile);
+}
@@ -0,0 +1,75 @@
+/**
+ * @file /src/takeoff/model/menu/XdgMenuBackend.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  XdgMenuBackend
+ */
+#ifndef MODEL_XDGMENUBACKEND_H
+#define MODEL_XDGMENUBACKEND_H
+
+#include "MenuBackend.h"
+class XdgMenu;
+
+/**
+ * Backend that resolves the menu files of the xdg-menu standard with qtxdg, or
+ * reads them from takeoff-menud, see SharedMenu.
+ */
+class XdgMenuBackend : public MenuBackend
+{
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    XdgMenuBackend();
+
+    /**
+     * Destructor.
+     */
+    virtual ~XdgMenuBackend();
+
+    //--------------------------------------------------------------------------
+
+    virtual QDomDocument getXml() const;
+    virtual void unload();
+    virtual bool isOutDated() const;
+    virtual Type getType() const;
+
+    /**
+     * Sets if the menu is read from takeoff-menud when it is running. Enabled
+     * by default, takeoff-menubench disables it to measure the resolution of
+     * the menu files.
+     * @param enabled If takeoff-menud is used.
+     */
+    void setSharedMenuEnabled(bool enabled);
+
+protected:
+
+    virtual bool load();
+
+private:
+
+    /// The xdg-menu, kept to watch its files.
+    XdgMenu *xdgMenu;
+
+    /// If the menu is read from takeoff-menud when it is running.
+    bool sharedMenuEnabled;
+
+};
+
+#endif // MODEL_XDGMENUBACKEND_H
@@ -36,19 +36,23 @@
 //#include "xdgmime.h"
 // HACK The function bool XdgDesktopFilePrivate::startLinkDetached() const
 //      (line 776) is comented for remove the libmagic dependence.
+#ifndef QTXDG_NO_ICONS
 #include "xdgicon.h"
+#endif
 #include "xdgdirs.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <QtCore/QFile>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
 #include <QDebug>
 #include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <QtCore/QProcess>
 #include <QUrl>
-#include <QDesktopServices>
 #include <unistd.h>
+#include "../../../metrics/Metrics.h"
 
 class XdgDesktopFilePrivate {
 public:
@@ -65,8 +69,10 @@ public:
 
     bool isValid() const { return mIsValid; }
 
+    int memoryUsage() const;
+
     QVariant value(const QString& key, const QVariant& defaultValue = QVariant()) const;
-    QVariant localizedValue(const QString& key, const QVariant& defaultValue = QVariant()) const;
+    QVariant localizedValue(const QString& key, const QString& language, const QVariant& defaultValue) const;
 
     bool contains(const QString& key) const;
     bool isShow(const QString& environment) const;
@@ -74,13 +80,19 @@ public:
     bool startApplicationDetached(const QStringList& urls) const;
     bool startLinkDetached() const;
 
+#ifndef QTXDG_NO_ICONS
     QIcon const icon(const QIcon& fallback = QIcon()) const;
+#endif
 
     XdgDesktopFile::Type mType;
 protected:
     bool checkTryExec(const QString& progName) const;
     QStringList expandExecString(const QStringList& urls) const;
 
+    /*! Compiles the Exec key in the list of operations used by expandExecString(), so
+        the key is only tokenized once, when the file is read. */
+    void compileExec();
+
 
 private:
     enum IsShow {
@@ -94,10 +106,26 @@ private:
     Q_DECLARE_PUBLIC(XdgDesktopFile);
     QString mPrefix;
     QString mFileName;
+    QDateTime mModified;
     bool    mIsValid;
     QMap<QString, QVariant> mItems;
     mutable IsShow   mIsShow;
 
+    /*! An argument of the Exec key. The field codes are resolved when the file is read,
+        only the files and URLs are added on each launch. */
+    struct ExecOp {
+        enum Kind {
+            Literal,   //! The text is added as is.
+            File,      //! %f
+            FileList,  //! %F
+            Url,       //! %u
+            UrlList    //! %U
+        };
+        Kind kind;
+        QString text;
+    };
+    QList<ExecOp> mExecOps;
+
 };
 
 
@@ -168,6 +196,16 @@ bool XdgDesktopFile::isValid() const
     return d->isValid();
 }
 
+
+/************************************************
+
+ ************************************************/
+int XdgDesktopFile::memoryUsage() const
+{
+    Q_D(const XdgDesktopFile);
+    return sizeof(XdgDesktopFile) + d->memoryUsage();
+}
+
 /************************************************
 
  ************************************************/
@@ -178,6 +216,16 @@ QString XdgDesktopFile::fileName() const
 }
 
 
+/************************************************
+
+ ************************************************/
+QDateTime XdgDesktopFile::lastModified() const
+{
+    Q_D(const XdgDesktopFile);
+    return d->mModified;
+}
+
+
 /************************************************
 
  ************************************************/
@@ -194,7 +242,34 @@ QVariant XdgDesktopFile::value(const QString& key, const QVariant& defaultValue)
 QVariant XdgDesktopFile::localizedValue(const QString& key, const QVariant& defaultValue) const
 {
     Q_D(const XdgDesktopFile);
-    return d->localizedValue(key, defaultValue);
+    return d->localizedValue(key, environmentLanguage(), defaultValue);
+}
+
+
+/************************************************
+
+ ************************************************/
+QVariant XdgDesktopFile::localizedValue(const QString& key, const QString& language, const QVariant& defaultValue) const
+{
+    Q_D(const XdgDesktopFile);
+    return d->localizedValue(key, language, defaultValue);
+}
+
+
+/************************************************
+
+ ************************************************/
+QString XdgDesktopFile::environmentLanguage()
+{
+    QString lang = getenv("LC_MESSAGES");
+
+    if (lang.isEmpty())
+        lang = getenv("LC_ALL");
+
+    if (lang.isEmpty())
+         lang = getenv("LANG");
+
+    return lang;
 }
 
 
@@ -234,18 +309,94 @@ QStringList XdgDesktopFile::expandExecString(const QStringList& urls) const
 /************************************************
 
  ************************************************/
-QString expandDynamicUrl(QString url)
+static const QHash<QString, QString>& environmentSnapshot()
+{
+    // The environment of the process is read only once
+    static QHash<QString, QString> env;
+    static bool loaded = false;
+    if (!loaded)
+    {
+        for (int i=0; environ[i]; i++)
+        {
+            const char* line = environ[i];
+            const char* equal = strchr(line, '=');
+            if (!equal)
+                continue;
+
+            env.insert(QString::fromLocal8Bit(line, equal - line),
+                       QString::fromLocal8Bit(equal + 1));
+        }
+        loaded = true;
+    }
+
+    return env;
+}
+
+
+/************************************************
+ Replaces the $VAR and ${VAR} references in one pass. The unknown variables are
+ left as is.
+ ************************************************/
+QString expandDynamicUrl(const QString& url)
 {
-    for (int i=0; environ[i]; i++)
+    int dollar = url.indexOf('$');
+    if (dollar == -1)
+        return url;
+
+    const QHash<QString, QString>& env = environmentSnapshot();
+    QString result;
+    result.reserve(url.length());
+    result.append(url.leftRef(dollar));
+
+    const QChar* data = url.constData();
+    int length = url.length();
+    int i = dollar;
+    while (i < length)
     {
-        QString line(environ[i]);
-        QString name = line.section("=", 0, 0);
-        QString val =  line.section("=", 1);
-        url.replace(QString("$%1").arg(name), val);
-        url.replace(QString("${%1}").arg(name), val);
+        if (data[i] != '$')
+        {
+            result.append(data[i++]);
+            continue;
+        }
+
+        // ${VAR}
+        int nameStart, nameEnd, refEnd;
+        if (i+1 < length && data[i+1] == '{')
+        {
+            nameStart = i + 2;
+            nameEnd = nameStart;
+            while (nameEnd < length && data[nameEnd] != '}')
+                nameEnd++;
+
+            if (nameEnd == length)
+            {
+                result.append(data[i++]);
+                continue;
+            }
+            refEnd = nameEnd + 1;
+        }
+        // $VAR
+        else
+        {
+            nameStart = i + 1;
+            nameEnd = nameStart;
+            while (nameEnd < length &&
+                   (data[nameEnd].isLetterOrNumber() || data[nameEnd] == '_'))
+                nameEnd++;
+            refEnd = nameEnd;
+        }
+
+        QHash<QString, QString>::const_iterator it =
+                env.constFind(QString::fromRawData(data + nameStart, nameEnd - nameStart));
+        if (nameEnd == nameStart || it == env.constEnd())
+            result.append(url.midRef(i, refEnd - i));
+        else
+            result.append(it.value());
+
+        i = refEnd;
     }
 
-    return url;
+    return result;
 }
 
 
@@ -340,6 +491,7 @@ bool XdgDesktopFile::startDetached(const QString& url) const
 }
 
 
+#ifndef QTXDG_NO_ICONS
 /************************************************
   Returns an icon specified in this file.
  ************************************************/
@@ -348,6 +500,7 @@ QIcon const XdgDesktopFile::icon(const QIcon& fallback) const
     Q_D(const XdgDesktopFile);
     return d->icon(fallback);
 }
+#endif
 
 
 /************************************************
@@ -379,11 +532,13 @@ void XdgDesktopFilePrivate::setPrefix(const QString& prefix)
 XdgDesktopFilePrivate& XdgDesktopFilePrivate::operator=(const XdgDesktopFilePrivate& other)
 {
     mFileName = other.mFileName;
+    mModified = other.mModified;
     mPrefix = other.mPrefix;
     mIsValid = other.mIsValid;
     mItems = other.mItems; // This copy map values
     mIsShow = other.mIsShow;
     mType = other.mType;
+    mExecOps = other.mExecOps;
     return *this;
 }
 
@@ -394,6 +549,7 @@ XdgDesktopFilePrivate& XdgDesktopFilePrivate::operator=(const XdgDesktopFilePriv
 bool XdgDesktopFilePrivate::read()
 {
     QFile file(mFileName);
+    mModified = QFileInfo(file).lastModified();
 
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
         return false;
@@ -435,6 +591,7 @@ bool XdgDesktopFilePrivate::read()
 
     mType = detectType();
     mIsValid = valid;
+    compileExec();
     return valid;
 }
 
@@ -458,15 +615,11 @@ QVariant XdgDesktopFilePrivate::value(const QString& key, const QVariant& defaul
 // lang@MODIFIER	        lang@MODIFIER, lang, default value
 // lang	                lang, default value
 // ************************************************/
-QVariant XdgDesktopFilePrivate::localizedValue(const QString& key, const QVariant& defaultValue) const
+QVariant XdgDesktopFilePrivate::localizedValue(const QString& key, const QString& language, const QVariant& defaultValue) const
 {
-    QString lang = getenv("LC_MESSAGES");
-
+    QString lang = language;
     if (lang.isEmpty())
-        lang = getenv("LC_ALL");
-
-    if (lang.isEmpty())
-         lang = getenv("LANG");
+        return value(key, defaultValue);
 
 
     QString modifier = lang.section('@', 1);
@@ -532,6 +685,28 @@ bool XdgDesktopFilePrivate::contains(const QString& key) const
 }
 
 
+/************************************************
+ Every map node holds a key, a value and at least two pointers of the skip list.
+ ************************************************/
+int XdgDesktopFilePrivate::memoryUsage() const
+{
+    int ret = sizeof(XdgDesktopFilePrivate) + Metrics::sizeOf(mPrefix) + Metrics::sizeOf(mFileName);
+
+    QMap<QString, QVariant>::const_iterator i;
+    for (i = mItems.constBegin(); i != mItems.constEnd(); ++i)
+    {
+        ret += Metrics::sizeOf(i.key()) + sizeof(QVariant) + 2 * sizeof(void*);
+        if (i.value().type() == QVariant::String)
+            ret += Metrics::sizeOf(i.value().toString());
+    }
+
+    foreach (const ExecOp& op, mExecOps)
+        ret += sizeof(ExecOp) + Metrics::sizeOf(op.text);
+
+    return ret;
+}
+
+
 /************************************************
 
  ************************************************/
@@ -601,7 +776,7 @@ bool XdgDesktopFilePrivate::checkTryExec(const QString& progName) const
 /************************************************
 
  ************************************************/
-static QStringList parseCombinedArgString(const QString &program)
+static QStringList parseCombinedArgString(const QString &program, bool *ok)
 {
     QStringList args;
     QString tmp;
@@ -638,6 +813,12 @@ static QStringList parseCombinedArgString(const QString &program)
     if (!tmp.isEmpty())
         args += tmp;
 
+    // A quote at the end of the string still toggles the quoting
+    if (quoteCount == 1)
+        inQuote = !inQuote;
+
+    // An odd number of quotes leaves the last argument open
+    *ok = !inQuote;
     return args;
 }
 
@@ -645,100 +826,133 @@ static QStringList parseCombinedArgString(const QString &program)
 /************************************************
 
  ************************************************/
-QStringList XdgDesktopFilePrivate::expandExecString(const QStringList& urls) const
+void XdgDesktopFilePrivate::compileExec()
 {
-    QStringList result;
-    QStringList tokens = parseCombinedArgString(value("Exec").toString());
+    mExecOps.clear();
+    if (mType != XdgDesktopFile::ApplicationType)
+        return;
+
+    // The raw value, value() doubles the '&' for the menus
+    bool ok;
+    QStringList tokens = parseCombinedArgString(
+            mItems.value(mPrefix + "Exec").toString(), &ok);
+    if (!ok)
+        qWarning() << "XdgDesktopFile:" << mFileName << "has unbalanced quotes in the Exec key";
+
     foreach (QString token, tokens)
     {
+        ExecOp op;
+        op.kind = ExecOp::Literal;
+
         // ----------------------------------------------------------
         // A single file name, even if multiple files are selected.
         if (token == "%f")
-        {
-            if (!urls.isEmpty())
-                result << urls.at(0);
-            continue;
-        }
+            op.kind = ExecOp::File;
 
         // ----------------------------------------------------------
         // A list of files. Use for apps that can open several local files at once.
         // Each file is passed as a separate argument to the executable program.
-        if (token == "%F")
-        {
-            result << urls;
-            continue;
-        }
+        else if (token == "%F")
+            op.kind = ExecOp::FileList;
 
         // ----------------------------------------------------------
         // A single URL. Local files may either be passed as file: URLs or as file path.
-        if (token == "%u")
-        {
-            if (!urls.isEmpty())
-            {
-                QUrl url;
-                url.setUrl(urls.at(0));
-                result << ((!url.toLocalFile().isEmpty()) ? url.toLocalFile() : url.toEncoded());
-            }
-            continue;
-        }
+        else if (token == "%u")
+            op.kind = ExecOp::Url;
 
         // ----------------------------------------------------------
         // A list of URLs. Each URL is passed as a separate argument to the executable
         // program. Local files may either be passed as file: URLs or as file path.
-        if (token == "%U")
-        {
-            foreach (QString s, urls)
-            {
-                QUrl url(s);
-                result << ((!url.toLocalFile().isEmpty()) ? url.toLocalFile() : url.toEncoded());
-            }
-            continue;
-        }
+        else if (token == "%U")
+            op.kind = ExecOp::UrlList;
 
         // ----------------------------------------------------------
         // The Icon key of the desktop entry expanded as two arguments, first --icon
         // and then the value of the Icon key. Should not expand to any arguments if
         // the Icon key is empty or missing.
-        if (token == "%i")
+        else if (token == "%i")
         {
             QString icon = value("Icon").toString();
             if (!icon.isEmpty())
-                result << "-icon" << icon.replace('%', "%%");
+            {
+                op.text = "-icon";
+                mExecOps << op;
+                op.text = icon.replace('%', "%%");
+                mExecOps << op;
+            }
             continue;
         }
 
-
         // ----------------------------------------------------------
         // The translated name of the application as listed in the appropriate Name key
         // in the desktop entry.
-        if (token == "%c")
-        {
-            result << localizedValue("Name").toString().replace('%', "%%");
-            continue;
-        }
+        else if (token == "%c")
+            op.text = localizedValue("Name", XdgDesktopFile::environmentLanguage(), QVariant()).toString().replace('%', "%%");
 
         // ----------------------------------------------------------
         // The location of the desktop file as either a URI (if for example gotten from
         // the vfolder system) or a local filename or empty if no location is known.
-        if (token == "%k")
-        {
-            result << fileName().replace('%', "%%");
-            break;
-        }
+        else if (token == "%k")
+            op.text = QString(mFileName).replace('%', "%%");
 
         // ----------------------------------------------------------
         // Deprecated.
         // Deprecated field codes should be removed from the command line and ignored.
-        if (token == "%d" || token == "%D" ||
-            token == "%n" || token == "%N" ||
-            token == "%v" || token == "%m"
-            )
-        {
+        else if (token == "%d" || token == "%D" ||
+                 token == "%n" || token == "%N" ||
+                 token == "%v" || token == "%m"
+                )
             continue;
-        }
 
         // ----------------------------------------------------------
-        result << token;
+        else
+            op.text = token;
+
+        mExecOps << op;
+    }
+}
+
+
+/************************************************
+
+ ************************************************/
+QStringList XdgDesktopFilePrivate::expandExecString(const QStringList& urls) const
+{
+    QStringList result;
+    foreach (const ExecOp& op, mExecOps)
+    {
+        switch (op.kind)
+        {
+        case ExecOp::Literal:
+            result << op.text;
+            break;
+
+        case ExecOp::File:
+            if (!urls.isEmpty())
+                result << urls.at(0);
+            break;
+
+        case ExecOp::FileList:
+            result << urls;
+            break;
+
+        case ExecOp::Url:
+            if (!urls.isEmpty())
+            {
+                QUrl url;
+                url.setUrl(urls.at(0));
+                result << ((!url.toLocalFile().isEmpty()) ? url.toLocalFile() : url.toEncoded());
+            }
+            break;
+
+        case ExecOp::UrlList:
+            foreach (QString s, urls)
+            {
+                QUrl url(s);
+                result << ((!url.toLocalFile().isEmpty()) ? url.toLocalFile() : url.toEncoded());
+            }
+            break;
+        }
     }
 
     return result;
@@ -850,14 +1064,29 @@ QString findDesktopFile(const QString& desktopName)
 }
 
 
+/************************************************
+
+ ************************************************/
+static QHash<QString, XdgDesktopFile*>& desktopFilesCache()
+{
+    static QHash<QString, XdgDesktopFile*> cache;
+    return cache;
+}
+
+
 /************************************************
 
  ************************************************/
 XdgDesktopFile* XdgDesktopFileCache::getFile(const QString& fileName)
 {
-    static QHash<QString, XdgDesktopFile*> mDesktopFiles;
+    QHash<QString, XdgDesktopFile*>& mDesktopFiles = desktopFilesCache();
     if (mDesktopFiles.contains(fileName))
-         return mDesktopFiles.value(fileName);
+    {
+        Metrics::add(Metrics::DESKTOP_FILE_CACHE_HITS);
+        return mDesktopFiles.value(fileName);
+    }
+
+    Metrics::add(Metrics::DESKTOP_FILE_CACHE_MISSES);
 
 
     if (fileName.startsWith(QDir::separator()))
@@ -865,6 +1094,7 @@ XdgDesktopFile* XdgDesktopFileCache::getFile(const QString& fileName)
         // Absolute path ........................
         //qDebug() << "XdgDesktopFileCache: add new file" << fileName;
         XdgDesktopFile* desktopFile = new XdgDesktopFile(fileName);
+        Metrics::allocate(Metrics::DESKTOP_FILE_CACHE, desktopFile->memoryUsage());
         mDesktopFiles.insert(fileName, desktopFile);
         return desktopFile;
     }
@@ -878,6 +1108,7 @@ XdgDesktopFile* XdgDesktopFileCache::getFile(const QString& fileName)
         if (!mDesktopFiles.contains(filePath))
         {
             desktopFile = new XdgDesktopFile(filePath);
+            Metrics::allocate(Metrics::DESKTOP_FILE_CACHE, desktopFile->memoryUsage());
             mDesktopFiles.insert(filePath, desktopFile);
         }
         else
@@ -891,6 +1122,37 @@ XdgDesktopFile* XdgDesktopFileCache::getFile(const QString& fileName)
 
 
 
+/************************************************
+ The same file can be cached with several names.
+ ************************************************/
+void XdgDesktopFileCache::clear()
+{
+    QHash<QString, XdgDesktopFile*>& mDesktopFiles = desktopFilesCache();
+    foreach (XdgDesktopFile* desktopFile, mDesktopFiles.values().toSet())
+    {
+        Metrics::release(Metrics::DESKTOP_FILE_CACHE, desktopFile->memoryUsage());
+        delete desktopFile;
+    }
+
+    mDesktopFiles.clear();
+}
+
+
+/************************************************
+ The file is replaced in place, the other names of the file in the cache point
+ to the same object.
+ ************************************************/
+void XdgDesktopFileCache::refresh(XdgDesktopFile* desktopFile)
+{
+    if (QFileInfo(desktopFile->fileName()).lastModified() == desktopFile->lastModified())
+        return;
+
+    Metrics::release(Metrics::DESKTOP_FILE_CACHE, desktopFile->memoryUsage());
+    *desktopFile = XdgDesktopFile(desktopFile->fileName());
+    Metrics::allocate(Metrics::DESKTOP_FILE_CACHE, desktopFile->memoryUsage());
+}
+
+
 /************************************************
 
  ************************************************/
@@ -962,6 +1224,7 @@ XdgDesktopFile* XdgDesktopFileCache::getDefaultApp(const QString& mimeType)
 }
 
 
+#ifndef QTXDG_NO_ICONS
 /************************************************
 
  ************************************************/
@@ -969,3 +1232,4 @@ QIcon const XdgDesktopFilePrivate::icon(const QIcon& fallback) const
 {
     return XdgIcon::fromTheme(value("Icon").toString(), fallback);
 }
+#endif
@@ -33,7 +33,10 @@
 #include <QString>
 #include <QVariant>
 #include <QStringList>
+#include <QDateTime>
+#ifndef QTXDG_NO_ICONS
 #include <QIcon>
+#endif
 
 class XdgDesktopFilePrivate;
 
@@ -85,6 +88,15 @@ public:
         If no default value is specified, a default QVariant is returned. */
     QVariant localizedValue(const QString& key, const QVariant& defaultValue = QVariant()) const;
 
+    /*! Returns the localized value for key in the given language instead of the language
+        of the environment. The language has the same form as LOCALE, an empty one selects
+        the non localized value. */
+    QVariant localizedValue(const QString& key, const QString& language, const QVariant& defaultValue) const;
+
+    /*! Returns the language used by localizedValue(): the value of LC_MESSAGES, LC_ALL
+        or LANG, the first that is set. */
+    static QString environmentLanguage();
+
     //! Returns true if there exists a setting called key; returns false otherwise.
     bool contains(const QString& key) const;
 
@@ -94,6 +106,9 @@ public:
     //! Returns the file name of the desktop file.
     QString fileName() const;
 
+    //! Returns the modification time of the file when it was read.
+    QDateTime lastModified() const;
+
     /*! The desktop entry specification defines a number of fields to control the visibility of the application menu. This function
      checks whether to display a this application or not. */
     bool isShow(const QString& environment = "RAZOR") const;
@@ -126,7 +141,10 @@ public:
     //! This function is provided for convenience. It's equivalent to calling startDetached(QStringList(url)).
     bool startDetached(const QString& url="") const;
 
+#ifndef QTXDG_NO_ICONS
+    //! Not available when the library is built without QtGui, with QTXDG_NO_ICONS defined.
     QIcon const icon(const QIcon& fallback = QIcon()) const;
+#endif
 
     //! This function is provided for convenience. It's equivalent to calling localizedValue("Name").toString().
     QString name() const { return localizedValue("Name").toString(); }
@@ -134,6 +152,9 @@ public:
     //! This function is provided for convenience. It's equivalent to calling localizedValue("Comment").toString().
     QString comment() const { return localizedValue("Comment").toString(); }
 
+    //! Returns the estimated memory used by the file and its keys, in bytes.
+    int memoryUsage() const;
+
 private:
     XdgDesktopFilePrivate* const d_ptr;
     Q_DECLARE_PRIVATE(XdgDesktopFile)
@@ -147,6 +168,14 @@ class XdgDesktopFileCache
 public:
     static XdgDesktopFile* getFile(const QString& fileName);
     static XdgDesktopFile* getDefaultApp(const QString& mimeType);
+
+    //! Deletes the cached files, so they are read again. The pointers returned by
+    //! getFile() are invalid after calling it, and getDefaultApp() must not be used.
+    static void clear();
+
+    //! Reads a cached file again if it was modified after it was read. The pointer
+    //! returned by getFile() stays valid.
+    static void refresh(XdgDesktopFile* desktopFile);
 };
 
 
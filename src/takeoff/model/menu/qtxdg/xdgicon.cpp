@@ -33,6 +33,7 @@
 #include <QDir>
 #include <QStringList>
 #include <QFileInfo>
+#include "../../../metrics/Metrics.h"
 
 #define DEFAULT_APP_ICON "application-x-executable"
 
@@ -223,9 +224,16 @@ QIcon* const XdgIconCache::fromTheme(const QString& iconName)
     if (!icon.isNull())
     {
         QIcon* res = new QIcon();
+        int bytes = sizeof(QIcon) + Metrics::sizeOf(key);
         foreach (QSize s, icon.availableSizes())
-            res->addPixmap(icon.pixmap(s));
-
+        {
+            QPixmap pixmap = icon.pixmap(s);
+            res->addPixmap(pixmap);
+            bytes += pixmap.width() * pixmap.height() * pixmap.depth() / 8;
+        }
+
+        // The copies are never freed
+        Metrics::allocate(Metrics::ICON_CACHE, bytes);
         mCache[key]= res;
         return res;
     }
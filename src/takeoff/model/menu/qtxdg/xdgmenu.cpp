@@ -34,6 +34,8 @@
 #include "xdgmenuapplinkprocessor.h"
 #include "xdgdirs.h"
 #include "xdgmenulayoutprocessor.h"
+#include "../../../metrics/Metrics.h"
+#include "../../../trace/Trace.h"
 
 #include <QDebug>
 #include <QtXml/QDomElement>
@@ -63,6 +65,7 @@ XdgMenu::XdgMenu(QObject *parent) :
 XdgMenu::~XdgMenu()
 {
     Q_D(XdgMenu);
+    d->releaseXml();
     delete d;
 }
 
@@ -71,6 +74,8 @@ XdgMenu::~XdgMenu()
 
  ************************************************/
 XdgMenuPrivate::XdgMenuPrivate(XdgMenu *parent):
+    mLanguage(XdgDesktopFile::environmentLanguage()),
+    mXmlBytes(0),
     mOutDated(true),
     q_ptr(parent)
 {
@@ -129,6 +134,26 @@ QStringList& XdgMenu::environments()
 }
 
 
+/************************************************
+
+ ************************************************/
+QString XdgMenu::language() const
+{
+    Q_D(const XdgMenu);
+    return d->mLanguage;
+}
+
+
+/************************************************
+
+ ************************************************/
+void XdgMenu::setLanguage(const QString& language)
+{
+    Q_D(XdgMenu);
+    d->mLanguage = language;
+}
+
+
 /************************************************
 
  ************************************************/
@@ -148,50 +173,57 @@ bool XdgMenu::read(const QString& menuFileName)
 
     d->mMenuFileName = menuFileName;
 
+    TAKEOFF_TRACE_SPAN("XdgMenu::read");
     d->clearWatcher();
 
-    XdgMenuReader reader(this);
-    if (!reader.load(d->mMenuFileName))
     {
-        qWarning() << reader.errorString();
-        d->mErrorString = reader.errorString();
-        return false;
+        TAKEOFF_TRACE_SPAN("XdgMenuReader::load");
+        XdgMenuReader reader(this);
+        if (!reader.load(d->mMenuFileName))
+        {
+            qWarning() << reader.errorString();
+            d->mErrorString = reader.errorString();
+            return false;
+        }
+
+        d->mXml = reader.xml();
     }
 
-    d->mXml = reader.xml();
     QDomElement root = d->mXml.documentElement();
     d->saveLog("00-reader.xml");
 
-    d->simplify(root);
+    { TAKEOFF_TRACE_SPAN("XdgMenu::simplify"); d->simplify(root); }
     d->saveLog("01-simplify.xml");
 
-    d->mergeMenus(root);
+    { TAKEOFF_TRACE_SPAN("XdgMenu::mergeMenus"); d->mergeMenus(root); }
     d->saveLog("02-mergeMenus.xml");
 
-    d->moveMenus(root);
+    { TAKEOFF_TRACE_SPAN("XdgMenu::moveMenus"); d->moveMenus(root); }
     d->saveLog("03-moveMenus.xml");
 
-    d->mergeMenus(root);
+    { TAKEOFF_TRACE_SPAN("XdgMenu::mergeMenus"); d->mergeMenus(root); }
     d->saveLog("04-mergeMenus.xml");
 
-    d->deleteDeletedMenus(root);
+    { TAKEOFF_TRACE_SPAN("XdgMenu::deleteDeletedMenus"); d->deleteDeletedMenus(root); }
     d->saveLog("05-deleteDeletedMenus.xml");
 
-    d->processDirectoryEntries(root, QStringList());
+    { TAKEOFF_TRACE_SPAN("XdgMenu::processDirectoryEntries"); d->processDirectoryEntries(root, QStringList()); }
     d->saveLog("06-processDirectoryEntries.xml");
 
-    d->processApps(root);
+    { TAKEOFF_TRACE_SPAN("XdgMenu::processApps"); d->processApps(root); }
     d->saveLog("07-processApps.xml");
 
-    d->processLayouts(root);
+    { TAKEOFF_TRACE_SPAN("XdgMenu::processLayouts"); d->processLayouts(root); }
     d->saveLog("08-processLayouts.xml");
 
-    d->deleteEmpty(root);
+    { TAKEOFF_TRACE_SPAN("XdgMenu::deleteEmpty"); d->deleteEmpty(root); }
     d->saveLog("09-deleteEmpty.xml");
 
-    d->fixSeparators(root);
+    { TAKEOFF_TRACE_SPAN("XdgMenu::fixSeparators"); d->fixSeparators(root); }
     d->saveLog("10-fixSeparators.xml");
 
+    // The document is kept until the next read
+    d->accountXml();
 
     d->mOutDated = false;
 
@@ -199,6 +231,47 @@ bool XdgMenu::read(const QString& menuFileName)
 }
 
 
+/************************************************
+
+ ************************************************/
+bool XdgMenu::readResolved(const QString& menuFileName, const QByteArray& xml, const QStringList& watchPaths)
+{
+    Q_D(XdgMenu);
+
+    TAKEOFF_TRACE_SPAN("XdgMenu::readResolved");
+    d->mMenuFileName = menuFileName;
+    d->clearWatcher();
+
+    QString errorMsg;
+    int errorLine;
+    if (!d->mXml.setContent(xml, &errorMsg, &errorLine))
+    {
+        d->releaseXml();
+        d->mErrorString = QString("Parse error at line %1: %2").arg(errorLine).arg(errorMsg);
+        return false;
+    }
+
+    foreach (QString path, watchPaths)
+        addWatchPath(path);
+
+    d->accountXml();
+
+    d->mOutDated = false;
+    return true;
+}
+
+
+/************************************************
+
+ ************************************************/
+void XdgMenu::unload()
+{
+    Q_D(XdgMenu);
+    d->mXml = QDomDocument();
+    d->releaseXml();
+}
+
+
 /************************************************
 
  ************************************************/
@@ -556,8 +629,8 @@ bool XdgMenuPrivate::loadDirectoryFile(const QString& fileName, QDomElement& ele
         return false;
 
 
-    element.setAttribute("title", file.localizedValue("Name").toString());
-    element.setAttribute("comment", file.localizedValue("Comment").toString());
+    element.setAttribute("title", file.localizedValue("Name", mLanguage, QVariant()).toString());
+    element.setAttribute("comment", file.localizedValue("Comment", mLanguage, QVariant()).toString());
     element.setAttribute("icon", file.value("Icon").toString());
 
     Q_Q(XdgMenu);
@@ -703,6 +776,16 @@ bool XdgMenu::isOutDated() const
 }
 
 
+/************************************************
+
+ ************************************************/
+QStringList XdgMenu::watchPaths() const
+{
+    Q_D(const XdgMenu);
+    return d->mWatcher.files() + d->mWatcher.directories();
+}
+
+
 /************************************************
 
  ************************************************/
@@ -724,3 +807,50 @@ void XdgMenuPrivate::clearWatcher()
     if (sl.length())
         mWatcher.removePaths(sl);
 }
+
+
+/************************************************
+ Accounts the loaded document, walking it once. The estimate of a node is the
+ private node of Qt and the strings of its name and value. The metrics only
+ read the stored size until the document is replaced or released.
+ ************************************************/
+void XdgMenuPrivate::accountXml()
+{
+    releaseXml();
+
+    const int nodeSize = 12 * sizeof(void*);
+    int bytes = 0;
+    QList<QDomNode> pending;
+    pending << mXml;
+    while (!pending.isEmpty())
+    {
+        QDomNode node = pending.takeLast();
+        bytes += nodeSize + Metrics::sizeOf(node.nodeName()) + Metrics::sizeOf(node.nodeValue());
+
+        QDomNamedNodeMap attrs = node.attributes();
+        for (int i=0; i<attrs.count(); ++i)
+        {
+            QDomNode attr = attrs.item(i);
+            bytes += nodeSize + Metrics::sizeOf(attr.nodeName()) + Metrics::sizeOf(attr.nodeValue());
+        }
+
+        for (QDomNode n = node.firstChild(); !n.isNull(); n = n.nextSibling())
+            pending << n;
+    }
+
+    mXmlBytes = bytes;
+    Metrics::allocate(Metrics::XDG_MENU_DOM, mXmlBytes);
+}
+
+
+/************************************************
+ Releases the accounting of the document, when it is unloaded.
+ ************************************************/
+void XdgMenuPrivate::releaseXml()
+{
+    if (!mXmlBytes)
+        return;
+
+    Metrics::release(Metrics::XDG_MENU_DOM, mXmlBytes);
+    mXmlBytes = 0;
+}
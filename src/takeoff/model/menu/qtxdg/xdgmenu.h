@@ -73,8 +73,20 @@ public:
     virtual ~XdgMenu();
 
     bool read(const QString& menuFileName);
+
+    /*!
+     * Loads a menu already resolved by read() in other process, from the XML returned
+     * by xml(). The watched paths are used to know when the menu is outdated.
+     */
+    bool readResolved(const QString& menuFileName, const QByteArray& xml, const QStringList& watchPaths);
     void save(const QString& fileName);
 
+    /*!
+     * Frees the document returned by xml() once it has been used. The paths are
+     * still watched, so isOutDated() keeps working.
+     */
+    void unload();
+
     const QDomDocument xml() const;
     QString menuFileName() const;
 
@@ -83,6 +95,13 @@ public:
     /// A list of strings identifying the environments that should display a desktop entry.
     QStringList& environments();
 
+    /*!
+     * The language of the titles and comments, with the form of LC_MESSAGES. By default
+     * the language of the environment, see XdgDesktopFile::environmentLanguage().
+     */
+    QString language() const;
+    void setLanguage(const QString& language);
+
     /*!
      * Returns a string description of the last error that occurred if read() returns false.
      */
@@ -103,6 +122,9 @@ public:
 
     bool isOutDated() const;
 
+    /// The files and directories that make the menu outdated when they change.
+    QStringList watchPaths() const;
+
 protected:
     void addWatchPath(const QString& path);
 
@@ -58,11 +58,16 @@ public:
 
     void clearWatcher();
 
+    void accountXml();
+    void releaseXml();
+
     QString mErrorString;
     QStringList mEnvironments;
+    QString mLanguage;
     QString mMenuFileName;
     QString mLogDir;
     QDomDocument mXml;
+    int mXmlBytes;
 
     QFileSystemWatcher mWatcher;
     bool mOutDated;
@@ -122,83 +122,100 @@ void XdgMenuApplinkProcessor::step2()
             continue;
 
         XdgDesktopFile* file = fileInfo->desktopFile();
-
-        // Means "this application exists, but don't display it in the menus".
-        if (file->value("NoDisplay").toBool())
+        if (!isDisplayed(*file, mMenu->environments()))
             continue;
 
-        // Hidden should have been called Deleted. It means the user deleted
-        // (at his level) something that was present
-        if (file->value("Hidden").toBool())
-            continue;
+        QDomElement appLink = doc.createElement("AppLink");
+        fillAppLink(appLink, fileInfo->id(), *file, mMenu->language());
+        mElement.appendChild(appLink);
+
+    }
 
-        // File name of a binary on disk used to determine if the program is
-        // actually installed. If not, entry may not show in menus, etc.
-        QString s = file->value("TryExec").toString();
-        if (!s.isEmpty() && !checkTryExec(s))
-            continue;
 
-        // A list of strings identifying the environments that should display/not
-        // display a given desktop entry.
-        // OnlyShowIn ........
-        if (file->contains("OnlyShowIn"))
+    // Process childs menus ...............................
+    foreach (XdgMenuApplinkProcessor* child, mChilds)
+        child->step2();
+}
+
+
+/************************************************
+ Checks the keys that hide a desktop entry from the menus.
+ ************************************************/
+bool XdgMenuApplinkProcessor::isDisplayed(const XdgDesktopFile& file, const QStringList& environments)
+{
+    // Means "this application exists, but don't display it in the menus".
+    if (file.value("NoDisplay").toBool())
+        return false;
+
+    // Hidden should have been called Deleted. It means the user deleted
+    // (at his level) something that was present
+    if (file.value("Hidden").toBool())
+        return false;
+
+    // File name of a binary on disk used to determine if the program is
+    // actually installed. If not, entry may not show in menus, etc.
+    QString s = file.value("TryExec").toString();
+    if (!s.isEmpty() && !checkTryExec(s))
+        return false;
+
+    // A list of strings identifying the environments that should display/not
+    // display a given desktop entry.
+    // OnlyShowIn ........
+    if (file.contains("OnlyShowIn"))
+    {
+        QString s = ";" + file.value("OnlyShowIn").toString() + ";";
+        bool show = false;
+        foreach (QString env, environments)
         {
-            QString s = ";" + file->value("OnlyShowIn").toString() + ";";
-            bool show = false;
-            foreach (QString env, mMenu->environments())
+            if (s.contains(env))
             {
-                if (s.contains(env))
-                {
-                    show = true;
-                    break;
-                }
+                show = true;
+                break;
             }
-
-            if (!show)
-                continue;
         }
 
-        // NotShowIn .........
-        if (file->contains("NotShowIn"))
+        if (!show)
+            return false;
+    }
+
+    // NotShowIn .........
+    if (file.contains("NotShowIn"))
+    {
+        QString s = ";" + file.value("NotShowIn").toString() + ";";
+        bool show = true;
+        foreach (QString env, environments)
         {
-            QString s = ";" + file->value("NotShowIn").toString() + ";";
-            bool show = true;
-            foreach (QString env, mMenu->environments())
+            if (s.contains(env))
             {
-                if (s.contains(env))
-                {
-                    show = false;
-                    break;
-                }
+                show = false;
+                break;
             }
-
-            if (!show)
-                continue;
         }
 
-
-
-        QDomElement appLink = doc.createElement("AppLink");
-
-        appLink.setAttribute("id", fileInfo->id());
-        appLink.setAttribute("title", file->localizedValue("Name").toString());
-        appLink.setAttribute("comment", file->localizedValue("Comment").toString());
-        appLink.setAttribute("genericName", file->localizedValue("GenericName").toString());
-        appLink.setAttribute("exec", file->value("Exec").toString());
-        appLink.setAttribute("terminal", file->value("Terminal").toBool());
-        appLink.setAttribute("startupNotify", file->value("StartupNotify").toBool());
-        appLink.setAttribute("path", file->value("Path").toString());
-        appLink.setAttribute("icon", file->value("Icon").toString());
-        appLink.setAttribute("desktopFile", file->fileName());
-
-        mElement.appendChild(appLink);
-
+        if (!show)
+            return false;
     }
 
+    return true;
+}
 
-    // Process childs menus ...............................
-    foreach (XdgMenuApplinkProcessor* child, mChilds)
-        child->step2();
+
+/************************************************
+ Sets the attributes of an <AppLink> element from the desktop entry.
+ ************************************************/
+void XdgMenuApplinkProcessor::fillAppLink(QDomElement& appLink, const QString& id, const XdgDesktopFile& file, const QString& language)
+{
+    appLink.setAttribute("id", id);
+    appLink.setAttribute("title", file.localizedValue("Name", language, QVariant()).toString());
+    appLink.setAttribute("comment", file.localizedValue("Comment", language, QVariant()).toString());
+    appLink.setAttribute("genericName", file.localizedValue("GenericName", language, QVariant()).toString());
+    appLink.setAttribute("keywords", file.localizedValue("Keywords", language, QVariant()).toString());
+    appLink.setAttribute("exec", file.value("Exec").toString());
+    appLink.setAttribute("terminal", file.value("Terminal").toBool());
+    appLink.setAttribute("startupNotify", file.value("StartupNotify").toBool());
+    appLink.setAttribute("path", file.value("Path").toString());
+    appLink.setAttribute("icon", file.value("Icon").toString());
+    appLink.setAttribute("desktopFile", file.fileName());
 }
 
 
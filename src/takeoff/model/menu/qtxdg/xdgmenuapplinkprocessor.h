@@ -52,6 +52,12 @@ public:
     virtual ~XdgMenuApplinkProcessor();
     void run();
 
+    /// Returns false if the keys of the desktop entry hide it in the specified environments.
+    static bool isDisplayed(const XdgDesktopFile& file, const QStringList& environments);
+
+    /// Sets the attributes of an <AppLink> element from a desktop entry, translated to the language.
+    static void fillAppLink(QDomElement& appLink, const QString& id, const XdgDesktopFile& file, const QString& language);
+
 protected:
     void step1();
     void step2();
@@ -60,7 +66,7 @@ protected:
 
     //bool loadDirectoryFile(const QString& fileName, QDomElement& element);
     void createRules();
-    bool checkTryExec(const QString& progName);
+    static bool checkTryExec(const QString& progName);
 
 private:
     XdgMenuApplinkProcessor* mParent;
@@ -0,0 +1,343 @@
+/**
+ * @file /src/takeoff/model/search/SearchIndex.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  SearchIndex
+ */
+#include "SearchIndex.h"
+#include <QtCore/QPair>
+#include <QtCore/QRegExp>
+#include <QtCore/QStringList>
+
+// ************************************************************************** //
+// **********             STATIC METHODS AND VARIABLES             ********** //
+// ************************************************************************** //
+
+const int SearchIndex::FIELD_WEIGHTS[SearchIndex::NUM_FIELDS] = {
+    16, // NAME
+    8,  // GENERIC_NAME
+    6,  // KEYWORDS
+    3,  // COMMENT
+    2   // EXEC
+};
+
+namespace {
+
+/// Posting of the field of an application.
+inline quint32 makePosting(int app, int field)
+{
+    return (quint32(app) << 3) | quint32(field);
+}
+
+/// Number of postings to check between two cancellation checks.
+const int POSTINGS_PER_CHECK = 512;
+
+/// Indicates if the generation counter has changed.
+inline bool isCancelled(const QAtomicInt *generation, int expectedGeneration)
+{
+    return generation != NULL && int(*generation) != expectedGeneration;
+}
+
+/**
+ * Letters without a canonical decomposition that are usually typed without
+ * their stroke or dot.
+ */
+const ushort STROKED_LETTERS[][2] = {
+    { 0x0111, 'd' }, // LATIN SMALL LETTER D WITH STROKE
+    { 0x0127, 'h' }, // LATIN SMALL LETTER H WITH STROKE
+    { 0x0131, 'i' }, // LATIN SMALL LETTER DOTLESS I
+    { 0x0142, 'l' }, // LATIN SMALL LETTER L WITH STROKE
+    { 0x00F8, 'o' }, // LATIN SMALL LETTER O WITH STROKE
+    { 0x0167, 't' }  // LATIN SMALL LETTER T WITH STROKE
+};
+
+/// Returns the character without stroke, or the same character.
+inline QChar unstroke(QChar c)
+{
+    if (c.unicode() < 0x00F8)
+        return c;
+
+    for (uint n=0; n<sizeof(STROKED_LETTERS)/sizeof(STROKED_LETTERS[0]); n++)
+        if (c.unicode() == STROKED_LETTERS[n][0])
+            return QChar(STROKED_LETTERS[n][1]);
+
+    return c;
+}
+
+/**
+ * Returns the position of the first occurrence of the word in the text, or -1.
+ * Both are already folded, so the code units are compared directly.
+ */
+int find(const QChar *text, int length, const QString &word)
+{
+    const QChar *w = word.constData();
+    int wordLength = word.length();
+
+    for (int pos=0; pos+wordLength<=length; pos++) {
+        if (text[pos] != w[0])
+            continue;
+
+        int n = 1;
+        while (n < wordLength && text[pos+n] == w[n])
+            n++;
+        if (n == wordLength)
+            return pos;
+    }
+
+    return -1;
+}
+
+/// Sorts the results by relevance and, in case of draw, by menu order.
+bool moreRelevant(const QPair<int, int> &a, const QPair<int, int> &b)
+{
+    if (a.first != b.first)
+        return a.first > b.first;
+    return a.second < b.second;
+}
+
+}
+
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+SearchIndex::SearchIndex()
+{
+
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC METHODS                    ********** //
+// ************************************************************************** //
+
+void SearchIndex::addApplication(int id, const QString fields[NUM_FIELDS])
+{
+    int app = this->ids.size();
+    this->ids.append(id);
+
+    for (int f=0; f<NUM_FIELDS; f++) {
+        QString text = normalize(fields[f], (Field)f);
+        this->fieldsOffsets.append(this->fieldsBuffer.length());
+        this->fieldsBuffer.append(text);
+
+        // Queries are split by spaces, so the grams with spaces are never used
+        quint32 posting = makePosting(app, f);
+        for (int n=0; n+1<text.length(); n++) {
+            if (text.at(n) == ' ' || text.at(n+1) == ' ')
+                continue;
+
+            this->addPosting(gramKey(text, n, 2), posting);
+            if (n+2 < text.length() && text.at(n+2) != ' ')
+                this->addPosting(gramKey(text, n, 3), posting);
+        }
+    }
+}
+
+QList<int> SearchIndex::search(const QString &text,
+        const QHash<int, int> &boosts, const QAtomicInt *generation,
+        int expectedGeneration) const
+{
+    QStringList words = normalize(text, NAME).split(' ',
+            QString::SkipEmptyParts);
+
+    // Relevance of the applications that contains all the words seen so far
+    QHash<int, int> scores;
+    bool firstWord = true;
+
+    foreach (const QString &word, words) {
+        // Single characters are too common to narrow the search
+        if (word.length() < 2)
+            continue;
+
+        // Look for the gram of the word with less postings
+        int gramLength = (word.length() >= 3) ? 3 : 2;
+        const QVector<quint32> *rarest = NULL;
+        for (int n=0; n+gramLength<=word.length(); n++) {
+            QHash<quint64, QVector<quint32> >::const_iterator it =
+                    this->postings.constFind(gramKey(word, n, gramLength));
+            if (it == this->postings.constEnd())
+                return QList<int>();
+
+            if (rarest == NULL || it.value().size() < rarest->size())
+                rarest = &it.value();
+        }
+
+        // Every field containing the word contains the gram too, so checking
+        // its postings is enough to find the best field of each application
+        QHash<int, int> wordScores;
+        for (int n=0; n<rarest->size(); n++) {
+            if (n % POSTINGS_PER_CHECK == 0
+                    && isCancelled(generation, expectedGeneration))
+                return QList<int>();
+
+            quint32 posting = rarest->at(n);
+            int app   = posting >> 3;
+            int field = posting & 7;
+            if (!firstWord && !scores.contains(app))
+                continue;
+
+            int entry = app*NUM_FIELDS + field;
+            int begin = this->fieldsOffsets.at(entry);
+            int end = (entry+1 < this->fieldsOffsets.size())
+                    ? this->fieldsOffsets.at(entry+1)
+                    : this->fieldsBuffer.length();
+            int s = score(this->fieldsBuffer.constData() + begin, end - begin,
+                    (Field)field, word);
+            if (s > wordScores.value(app, 0))
+                wordScores.insert(app, s);
+        }
+
+        if (firstWord) {
+            scores = wordScores;
+        } else {
+            QHash<int, int> merged;
+            QHashIterator<int, int> it(wordScores);
+            while (it.hasNext()) {
+                it.next();
+                merged.insert(it.key(), scores.value(it.key()) + it.value());
+            }
+            scores = merged;
+        }
+
+        firstWord = false;
+        if (scores.isEmpty())
+            break;
+    }
+
+    // Sort by relevance
+    QList< QPair<int, int> > sorted;
+    QHashIterator<int, int> it(scores);
+    while (it.hasNext()) {
+        it.next();
+        int boost = boosts.value(this->ids.at(it.key()), 0);
+        sorted.append(qMakePair(it.value() + boost, it.key()));
+    }
+    if (isCancelled(generation, expectedGeneration))
+        return QList<int>();
+
+    qSort(sorted.begin(), sorted.end(), moreRelevant);
+
+    QList<int> ret;
+    for (int n=0; n<sorted.length(); n++)
+        ret.append(this->ids.at(sorted.at(n).second));
+
+    return ret;
+}
+
+int SearchIndex::count() const
+{
+    return this->ids.size();
+}
+
+void SearchIndex::squeeze()
+{
+    this->fieldsBuffer.squeeze();
+    this->fieldsOffsets.squeeze();
+    this->ids.squeeze();
+
+    QMutableHashIterator<quint64, QVector<quint32> > it(this->postings);
+    while (it.hasNext()) {
+        it.next();
+        it.value().squeeze();
+    }
+}
+
+QString SearchIndex::fold(const QString &text)
+{
+    // Split the accented characters in base character plus combining marks
+    // and the compatibility characters (ligatures, full width...) in their
+    // plain equivalent
+    QString decomposed = text.normalized(QString::NormalizationForm_KD)
+            .toCaseFolded();
+
+    QString ret;
+    ret.reserve(decomposed.length());
+    for (int n=0; n<decomposed.length(); n++) {
+        QChar c = decomposed.at(n);
+        QChar::Category category = c.category();
+        if (category == QChar::Mark_NonSpacing
+                || category == QChar::Mark_SpacingCombining
+                || category == QChar::Mark_Enclosing)
+            continue;
+
+        ret.append(unstroke(c));
+    }
+
+    return ret;
+}
+
+
+// ************************************************************************** //
+// **********                   PRIVATE METHODS                    ********** //
+// ************************************************************************** //
+
+QString SearchIndex::normalize(const QString &text, Field field)
+{
+    QString ret = fold(text);
+
+    // Keywords are separated by semicolons
+    if (field == KEYWORDS)
+        ret.replace(';', ' ');
+
+    // Remove the field codes (%f, %U...) of the command line
+    if (field == EXEC)
+        ret.remove(QRegExp("%[a-z]"));
+
+    return ret.simplified();
+}
+
+quint64 SearchIndex::gramKey(const QString &text, int pos, int length)
+{
+    // The UTF-16 code units are packed in 48 bits, the bigrams are marked with
+    // the bit 48 to don't collide with the trigrams starting with a 0 unit
+    quint64 key = (quint64(text.at(pos).unicode()) << 32)
+            | (quint64(text.at(pos+1).unicode()) << 16);
+    if (length == 3)
+        key |= quint64(text.at(pos+2).unicode());
+    else
+        key |= Q_UINT64_C(1) << 48;
+
+    return key;
+}
+
+void SearchIndex::addPosting(quint64 key, quint32 posting)
+{
+    // The postings of a field are added together, so checking the last one is
+    // enough to avoid duplicates
+    QVector<quint32> &list = this->postings[key];
+    if (list.isEmpty() || list.last() != posting)
+        list.append(posting);
+}
+
+int SearchIndex::score(const QChar *fieldText, int length, Field field,
+        const QString &word)
+{
+    int pos = find(fieldText, length, word);
+    if (pos == -1)
+        return 0;
+
+    // Matches at the beginning of the field or of a word are more relevant
+    int weight = FIELD_WEIGHTS[field];
+    if (pos == 0)
+        return weight * 2;
+    if (fieldText[pos-1] == ' ')
+        return weight + weight/2;
+
+    return weight;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file /src/takeoff/model/search/SearchIndex.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  SearchIndex
+ */
+#ifndef MODEL_SEARCHINDEX_H
+#define MODEL_SEARCHINDEX_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+/**
+ * Inverted index over the searchable fields of the applications. Every field
+ * is split in bigrams and trigrams and each gram points to the (application,
+ * field) pairs that contain it, so a query only visits the postings of its
+ * rarest gram instead of comparing every string of every application.
+ */
+class SearchIndex
+{
+
+public:
+
+    /**
+     * Fields of an application that can be searched. The order is also the
+     * order of relevance.
+     */
+    enum Field {
+        NAME,
+        GENERIC_NAME,
+        KEYWORDS,
+        COMMENT,
+        EXEC,
+        NUM_FIELDS
+    };
+
+    /**
+     * Default constructor. Creates an empty index.
+     */
+    SearchIndex();
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Adds an application to the index.
+     * @param id     Identifier returned by search() when the application
+     *        matches.
+     * @param fields The text of every field, indexed by SearchIndex::Field.
+     */
+    void addApplication(int id, const QString fields[NUM_FIELDS]);
+
+    /**
+     * Searches the applications that contains every word of the text in any of
+     * their fields. The search can be cancelled from other thread changing the
+     * value of the generation counter.
+     * @param  text       The text to search.
+     * @param  boosts     Relevance to add to the matching applications, by
+     *         identifier.
+     * @param  generation Counter to check if the search was cancelled, or NULL
+     *         to don't allow cancellation.
+     * @param  expectedGeneration Value of the counter while the search is not
+     *         cancelled.
+     * @return The identifiers of the matching applications, sorted by
+     *         relevance. An empty list if the search was cancelled.
+     */
+    QList<int> search(const QString &text,
+            const QHash<int, int> &boosts = QHash<int, int>(),
+            const QAtomicInt *generation = NULL,
+            int expectedGeneration = 0) const;
+
+    /**
+     * Returns the number of indexed applications.
+     * @return The number of applications.
+     */
+    int count() const;
+
+    /**
+     * Releases the memory reserved for the applications that will not be
+     * added. Call it once the index is complete.
+     */
+    void squeeze();
+
+    /**
+     * Folds the text to compare it ignoring case and accents: compatibility
+     * decomposition, removal of the combining marks and case folding.
+     * @param  text The text to fold.
+     * @return The folded text.
+     */
+    static QString fold(const QString &text);
+
+private:
+
+    /**
+     * Returns the text of a field in the form stored in the index.
+     * @param  text  The text to normalize.
+     * @param  field The field the text belongs to.
+     * @return The normalized text.
+     */
+    static QString normalize(const QString &text, Field field);
+
+    /**
+     * Returns the key of the gram of the specified length starting at the
+     * specified position.
+     * @param  text   The text containing the gram.
+     * @param  pos    Position of the first character of the gram.
+     * @param  length Length of the gram, 2 or 3.
+     * @return The key.
+     */
+    static quint64 gramKey(const QString &text, int pos, int length);
+
+    /**
+     * Adds a posting to the list of the specified gram, if it is not the last
+     * added one.
+     * @param key     The key of the gram.
+     * @param posting The (application, field) pair, see makePosting().
+     */
+    void addPosting(quint64 key, quint32 posting);
+
+    /**
+     * Returns the relevance of a word found in a field.
+     * @param  fieldText The normalized text of the field.
+     * @param  length    Length of the text of the field.
+     * @param  field     The field.
+     * @param  word      The normalized word.
+     * @return The relevance or 0 if the field doesn't contain the word.
+     */
+    static int score(const QChar *fieldText, int length, Field field,
+            const QString &word);
+
+    //--------------------------------------------------------------------------
+
+    /// Relevance of each field.
+    static const int FIELD_WEIGHTS[NUM_FIELDS];
+
+    /// Postings of each gram. A posting is (application << 3) | field.
+    QHash<quint64, QVector<quint32> > postings;
+
+    /// Normalized text of all the fields, one after the other.
+    QString fieldsBuffer;
+
+    /// Start of each field in fieldsBuffer, NUM_FIELDS consecutive per app.
+    QVector<int> fieldsOffsets;
+
+    /// Identifier of each indexed application.
+    QVector<int> ids;
+
+};
+
+#endif // MODEL_SEARCHINDEX_H
@@ -20,26 +20,59 @@
  */
 #include "Launcher.h"
 #include <QtGui/QGraphicsLinearLayout>
-#include <QtGui/QGraphicsSceneMouseEvent>
 #include <QtGui/QMenu>
-#include <KDE/KRun>
+#include <QtGui/QPixmapCache>
 #include <KDE/Plasma/IconWidget>
 #include <KDE/Plasma/ToolTipContent>
 #include <KDE/Plasma/ToolTipManager>
 #include <KDE/KIcon>
 #include "../model/config/Config.h"
 #include "../model/favorites/Favorites.h"
+#include "../model/history/LaunchHistory.h"
+#include "../model/launch/LaunchService.h"
+#include "../trace/Trace.h"
 using namespace Takeoff;
 
+// ************************************************************************** //
+// **********             STATIC METHODS AND VARIABLES             ********** //
+// ************************************************************************** //
+
+void Launcher::runApplication(const QString &desktopFile)
+{
+    LaunchService::getInstance()->launch(desktopFile);
+    LaunchHistory::getInstance()->addLaunch(desktopFile);
+}
+
+
 // ************************************************************************** //
 // **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
 // ************************************************************************** //
 
+LauncherData::LauncherData()
+        : subsystem(Metrics::LAUNCHERS)
+{
+
+}
+
+LauncherData::LauncherData(const QIcon &icon, const QString &name,
+        const QString &desktopFile, Metrics::Subsystem subsystem)
+        : icon(icon),
+          name(name),
+          desktopFile(desktopFile),
+          subsystem(subsystem)
+{
+
+}
+
+//------------------------------------------------------------------------------
+
 Launcher::Launcher(const QIcon &icon, const QString &name,
         const QString &desktopFile)
         : icon(icon),
           name(name),
-          desktopFile(desktopFile)
+          desktopFile(desktopFile),
+          toolTipRegistered(false),
+          subsystem(Metrics::LAUNCHERS)
 {
     this->init();
 }
@@ -48,11 +81,28 @@ Launcher::Launcher(const Launcher &launcher)
         : QGraphicsWidget(),
           icon(launcher.icon),
           name(launcher.name),
-          desktopFile(launcher.desktopFile)
+          desktopFile(launcher.desktopFile),
+          toolTipRegistered(false),
+          subsystem(Metrics::LAUNCHERS)
+{
+    this->init();
+}
+
+Launcher::Launcher(const LauncherData &data)
+        : icon(data.icon),
+          name(data.name),
+          desktopFile(data.desktopFile),
+          toolTipRegistered(false),
+          subsystem(data.subsystem)
 {
     this->init();
 }
 
+Launcher::~Launcher()
+{
+    Metrics::release(this->subsystem, this->getMemoryUsage());
+}
+
 
 // ************************************************************************** //
 // **********                   PRIVATE METHODS                    ********** //
@@ -60,22 +110,16 @@ Launcher::Launcher(const Launcher &launcher)
 
 void Launcher::init()
 {
+    Metrics::allocate(this->subsystem, this->getMemoryUsage());
+
     // Set the icon
     iconWidget = new Plasma::IconWidget(this->icon, "", this);
-
-    Config *cfg = Config::getInstance();
-    if (cfg->getSettings(Config::SHOW_ICON_TEXT).toBool())
-        iconWidget->setText(this->name);
-
-    connect(iconWidget, SIGNAL(clicked()), this, SLOT(runApplication()));
-    connect(iconWidget, SIGNAL(clicked()), this, SIGNAL(clicked()));
+    this->updateText();
 
     iconWidget->setDrawBackground(true);
-    // Set the tooltip
-    Plasma::ToolTipContent data;
-    data.setMainText(this->name);
-    data.setImage(this->icon.pixmap(32, 32));
-    Plasma::ToolTipManager::self()->setContent(iconWidget, data);
+
+    // The tooltip is registered the first time the mouse enters the launcher
+    this->setAcceptHoverEvents(true);
 
     // Add the icon to the layout
     QGraphicsLinearLayout *l = new QGraphicsLinearLayout(this);
@@ -83,6 +127,13 @@ void Launcher::init()
     this->setLayout(l);
 }
 
+int Launcher::getMemoryUsage() const
+{
+    return sizeof(Launcher) + sizeof(Plasma::IconWidget)
+            + sizeof(QGraphicsLinearLayout) + Metrics::sizeOf(this->name)
+            + Metrics::sizeOf(this->desktopFile);
+}
+
 
 // ************************************************************************** //
 // **********                    PUBLIC SLOTS                      ********** //
@@ -90,7 +141,7 @@ void Launcher::init()
 
 void Launcher::runApplication() const
 {
-    new KRun(KUrl(this->desktopFile), NULL);
+    Launcher::runApplication(this->desktopFile);
 }
 
 
@@ -102,14 +153,12 @@ void Launcher::addToFavorites() const
 {
     Favorites *favorites = Favorites::getInstance();
     favorites->addToFavorites(this);
-    emit this->addedToFavorites();
 }
 
 void Launcher::removeFromFavorites() const
 {
     Favorites *favorites = Favorites::getInstance();
     favorites->removeFromFavorites(this);
-    emit this->removedFromFavorites();
 }
 
 
@@ -117,23 +166,47 @@ void Launcher::removeFromFavorites() const
 // **********                    PUBLIC METHODS                    ********** //
 // ************************************************************************** //
 
-void Launcher::mousePressEvent(QGraphicsSceneMouseEvent *event)
+void Launcher::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
 {
-    if (event->button() == Qt::RightButton) {
-        QMenu menu;
-
-        Favorites *favorites = Favorites::getInstance();
-        if (favorites->isfavorite(this)) {
-            menu.addAction(KIcon("list-remove"), i18n("Remove from favorites"),
-                    this, SLOT(removeFromFavorites()));
+    // The launcher receives the event before its icon, so the tooltip is ready
+    // when the ToolTipManager handles the event of the icon
+    if (!this->toolTipRegistered) {
+        // The copies of a launcher share the icon, and its pixmap
+        QString key = QString("takeoff-tooltip-%1").arg(this->icon.cacheKey());
+        QPixmap pixmap;
+        if (QPixmapCache::find(key, &pixmap)) {
+            Metrics::add(Metrics::ICON_CACHE_HITS);
         } else {
-            menu.addAction(KIcon("favorites"), i18n("Add to favorites"),
-                    this, SLOT(addToFavorites()));
+            TAKEOFF_TRACE_SPAN("Launcher::loadToolTipIcon");
+            Metrics::add(Metrics::ICON_CACHE_MISSES);
+            pixmap = this->icon.pixmap(32, 32);
+            QPixmapCache::insert(key, pixmap);
         }
 
+        Plasma::ToolTipContent data;
+        data.setMainText(this->name);
+        data.setImage(pixmap);
+        Plasma::ToolTipManager::self()->setContent(this->iconWidget, data);
+        this->toolTipRegistered = true;
+    }
+
+    QGraphicsWidget::hoverEnterEvent(event);
+}
+
+void Launcher::showContextMenu()
+{
+    QMenu menu;
 
-        menu.exec(QCursor::pos());
+    Favorites *favorites = Favorites::getInstance();
+    if (favorites->isfavorite(this)) {
+        menu.addAction(KIcon("list-remove"), i18n("Remove from favorites"),
+                this, SLOT(removeFromFavorites()));
+    } else {
+        menu.addAction(KIcon("favorites"), i18n("Add to favorites"),
+                this, SLOT(addToFavorites()));
     }
+
+    menu.exec(QCursor::pos());
 }
 
 // ************************************************************************** //
@@ -145,11 +218,43 @@ QString Launcher::getName() const
     return this->name;
 }
 
+QIcon Launcher::getIcon() const
+{
+    return this->icon;
+}
+
 QString Launcher::getDesktopFile() const
 {
     return this->desktopFile;
 }
 
+LauncherData Launcher::getData() const
+{
+    return LauncherData(this->icon, this->name, this->desktopFile,
+            this->subsystem);
+}
+
+void Launcher::setSubsystem(Metrics::Subsystem subsystem)
+{
+    int bytes = this->getMemoryUsage();
+    Metrics::release(this->subsystem, bytes);
+    this->subsystem = subsystem;
+    Metrics::allocate(this->subsystem, bytes);
+}
+
+Metrics::Subsystem Launcher::getSubsystem() const
+{
+    return this->subsystem;
+}
+
+void Launcher::updateText()
+{
+    if (Config::getInstance()->getValues().showIconText)
+        this->iconWidget->setText(this->name);
+    else
+        this->iconWidget->setText("");
+}
+
 void Launcher::setBackground()
 {
 }
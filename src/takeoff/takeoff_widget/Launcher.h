@@ -23,6 +23,7 @@
 
 #include <QGraphicsWidget>
 #include <QtGui/QIcon>
+#include "../metrics/Metrics.h"
 
 namespace Plasma
 {
@@ -31,6 +32,41 @@ namespace Plasma
 
 namespace Takeoff  {
 
+/**
+ * Data of a launcher, enough to paint and run it. The panels are filled with
+ * it, so only the panels that show a widget per launcher create them.
+ */
+struct LauncherData
+{
+    /**
+     * Default constructor, an empty launcher.
+     */
+    LauncherData();
+
+    /**
+     * Constructor.
+     * @param icon        The icon of the launcher.
+     * @param name        Name to show under the icon.
+     * @param desktopFile Desktop file to execute.
+     * @param subsystem   Owner of the launcher in the memory accounting.
+     */
+    LauncherData(const QIcon &icon, const QString &name,
+            const QString &desktopFile,
+            Metrics::Subsystem subsystem = Metrics::LAUNCHERS);
+
+    /// The icon of the launcher.
+    QIcon icon;
+
+    /// The text to show under the icon.
+    QString name;
+
+    /// The desktop file to execute when the user click on the launcher.
+    QString desktopFile;
+
+    /// Owner of the launcher in the memory accounting.
+    Metrics::Subsystem subsystem;
+};
+
 /**
  * Launcher, contains the information about name, icon, and the command to
  * launch.
@@ -41,6 +77,14 @@ class Launcher : public QGraphicsWidget
 
 public:
 
+    /**
+     * Runs an application and adds it to the launch history.
+     * @param desktopFile The desktop file of the application.
+     */
+    static void runApplication(const QString &desktopFile);
+
+    //--------------------------------------------------------------------------
+
     /**
      * Default constructor.
      * @param icon The icon of the launcher. If a null-icon is passed Takeoff
@@ -58,13 +102,33 @@ public:
      */
     Launcher(const Launcher &launcher);
 
+    /**
+     * Creates the widget of a launcher.
+     * @param data The data of the launcher, including its owner in the memory
+     *        accounting.
+     */
+    explicit Launcher(const LauncherData &data);
+
+    /**
+     * Destructor.
+     */
+    virtual ~Launcher();
+
     //--------------------------------------------------------------------------
 
     /**
-     * Called whenever the user clicks over the launcher. Launch the popup menu.
+     * Called when the mouse enters the launcher. Registers the tooltip the
+     * first time.
      * @param event The information about the event.
      */
-    virtual void mousePressEvent(QGraphicsSceneMouseEvent *event);
+    virtual void hoverEnterEvent(QGraphicsSceneHoverEvent *event);
+
+    /**
+     * Shows the popup menu to add or remove the launcher from favorites at the
+     * position of the cursor. Called by the panel when the launcher is right
+     * clicked.
+     */
+    void showContextMenu();
 
     //--------------------------------------------------------------------------
 
@@ -74,33 +138,46 @@ public:
      */
     QString getName() const;
 
+    /**
+     * Returns the icon of the launcher.
+     * @return The icon.
+     */
+    QIcon getIcon() const;
+
     /**
      * Returns the desktop file associated with the launcher.
      * @return The desktop file.
      */
     QString getDesktopFile() const;
 
-signals:
+    /**
+     * Returns the data of the launcher, to add it to a panel without copying
+     * the widget.
+     * @return The data, owned by the same subsystem.
+     */
+    LauncherData getData() const;
 
     /**
-     * Signal that is emitted whenever the user click on the launcher.
+     * Sets the subsystem that owns the launcher in the memory accounting.
+     * @param subsystem The owner. Metrics::LAUNCHERS by default.
      */
-    void clicked() const;
+    void setSubsystem(Metrics::Subsystem subsystem);
 
     /**
-     * Signal that is emitted when the launcher is added to favorites.
+     * Returns the subsystem that owns the launcher in the memory accounting.
+     * @return The owner.
      */
-    void addedToFavorites() const;
+    Metrics::Subsystem getSubsystem() const;
 
     /**
-     * Signal that is emitted when the launcher is removed from favorites.
+     * Shows or hides the name under the icon according to the configuration.
      */
-    void removedFromFavorites() const;
+    void updateText();
 
 public slots:
 
     /**
-     * Runs the application when the icon is clicked.
+     * Runs the application. Called by the panel when the icon is clicked.
      */
     void runApplication() const;
 
@@ -123,6 +200,13 @@ private:
     /// Initializes the widget.
     void init();
 
+    /**
+     * Returns the estimated memory used by the launcher and its icon widget,
+     * without the pixmaps of the icon, that are shared by all the copies.
+     * @return The size in bytes.
+     */
+    int getMemoryUsage() const;
+
     //--------------------------------------------------------------------------
 
     /// The icon of the launcher.
@@ -136,6 +220,12 @@ private:
 
     Plasma::IconWidget* iconWidget;
 
+    /// Indicates if the tooltip has been registered in the ToolTipManager.
+    bool toolTipRegistered;
+
+    /// Owner of the launcher in the memory accounting.
+    Metrics::Subsystem subsystem;
+
 };
 
 }      // End namespace
@@ -19,13 +19,19 @@
  * @class  Takeoff::TakeoffWidget
  */
 #include "TakeoffWidget.h"
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
 #include <QtGui/QGraphicsLinearLayout>
+#include <QtGui/QImage>
 #include <QtGui/QPainter>
+#include <KDE/KDirWatch>
 #include <KDE/Plasma/TabBar>
 #include "Launcher.h"
 #include "menu/MenuWidget.h"
 #include "search/SearchWidget.h"
 #include "../model/config/Config.h"
+#include "../model/favorites/Favorites.h"
+#include "../trace/Trace.h"
 
 using namespace Takeoff;
 using namespace TakeoffPrivate;
@@ -38,6 +44,56 @@ using namespace Plasma;
                                || (x) == Qt::Key_Enter \
                                || (x) == Qt::Key_Return)
 
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/**
+ * Decodes the background image and scales it to the size of the widget in the
+ * background thread. The result is sent to the widget, that converts it to a
+ * pixmap in the GUI thread.
+ */
+class BackgroundJob : public QRunnable
+{
+public:
+    BackgroundJob(TakeoffWidget *takeoffWidget, const QString &path,
+            const QSize &size, int generation)
+            : takeoffWidget(takeoffWidget),
+              path(path),
+              size(size),
+              generation(generation)
+    {
+
+    }
+
+    virtual void run()
+    {
+        TAKEOFF_TRACE_SPAN("TakeoffWidget::loadBackground");
+        QImage image(this->path);
+        if (!image.isNull()) {
+            image = image.scaled(this->size, Qt::IgnoreAspectRatio,
+                    Qt::SmoothTransformation)
+                    .convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        }
+
+        QMetaObject::invokeMethod(this->takeoffWidget, "backgroundLoaded",
+                Qt::QueuedConnection,
+                Q_ARG(int, this->generation),
+                Q_ARG(QImage, image));
+    }
+
+private:
+    TakeoffWidget *takeoffWidget;
+    QString path;
+    QSize size;
+    int generation;
+};
+
+}
+
+
 // ************************************************************************** //
 // **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
 // ************************************************************************** //
@@ -46,9 +102,33 @@ TakeoffWidget::TakeoffWidget(QGraphicsWidget *parent)
         : Plasma::Applet(parent, "plasma-applet-takeoff.desktop"),
           tabBar(NULL),
           menuWidget(NULL),
-          searchWidget(NULL)
+          searchWidget(NULL),
+          backgroundDirty(false),
+          backgroundPool(new QThreadPool(this)),
+          backgroundGeneration(0)
 {
+    this->backgroundPool->setMaxThreadCount(1);
     this->reset();
+
+    // The background image is decoded again only when it is modified
+    KDirWatch *watch = KDirWatch::self();
+    connect(watch, SIGNAL(dirty(QString)),
+            this, SLOT(backgroundChanged(QString)));
+    connect(watch, SIGNAL(created(QString)),
+            this, SLOT(backgroundChanged(QString)));
+
+    // The favorites file can be edited from outside
+    connect(Favorites::getInstance(), SIGNAL(changed()),
+            this, SLOT(reloadFavorites()));
+}
+
+TakeoffWidget::~TakeoffWidget()
+{
+    // The background job sends the image to this widget
+    this->backgroundPool->waitForDone();
+
+    if (!this->backgroundPath.isEmpty())
+        KDirWatch::self()->removeFile(this->backgroundPath);
 }
 
 
@@ -61,14 +141,27 @@ void TakeoffWidget::addMenuCategory(const QIcon &icon, const QString &title)
     this->menuWidget->addMenuCategory(icon, title);
 }
 
-void TakeoffWidget::addMenuLauncher(int tabIndex, Launcher *launcher)
+void TakeoffWidget::addLazyMenuCategory(const QIcon &icon,
+        const QString &title, int first, int count)
+{
+    this->menuWidget->addLazyMenuCategory(icon, title, first, count);
+}
+
+void TakeoffWidget::addMenuLauncher(int tabIndex,
+        const LauncherData &launcher)
 {
     this->menuWidget->addMenuLauncher(tabIndex, launcher);
 }
 
+void TakeoffWidget::addMenuLaunchers(int tabIndex,
+        const QList<LauncherData> &launchers)
+{
+    this->menuWidget->addMenuLaunchers(tabIndex, launchers);
+}
+
 void TakeoffWidget::reset()
 {
-    Config::loadConfig();
+    TAKEOFF_TRACE_SPAN("TakeoffWidget::reset");
 
     // Contruct widgets
     delete this->tabBar;
@@ -78,19 +171,15 @@ void TakeoffWidget::reset()
 
     // Signals and slots
     connect(this->menuWidget, SIGNAL(clicked()), this, SIGNAL(clicked()));
-    connect(this->menuWidget, SIGNAL(addedToFavorites()),
-            this, SLOT(reloadFavorites()));
-    connect(this->menuWidget, SIGNAL(removedFromFavorites()),
-            this, SLOT(reloadFavorites()));
+    connect(Favorites::getInstance(), SIGNAL(added(int)),
+            this->menuWidget, SLOT(favoriteAdded(int)));
+    connect(Favorites::getInstance(), SIGNAL(removed(int)),
+            this->menuWidget, SLOT(favoriteRemoved(int)));
     connect(this, SIGNAL(keyPressedInMenu(QKeyEvent*)),
             this->menuWidget, SLOT(keyPressed(QKeyEvent*)));
 
     connect(this->searchWidget, SIGNAL(clicked()), this, SIGNAL(clicked()));
     connect(this->searchWidget, SIGNAL(exitSearch()), this, SLOT(exitSearch()));
-    connect(this->searchWidget, SIGNAL(addedToFavorites()),
-            this, SLOT(reloadFavorites()));
-    connect(this->searchWidget, SIGNAL(removedFromFavorites()),
-            this, SLOT(reloadFavorites()));
     connect(this, SIGNAL(keyPressedInSearch(QKeyEvent*)),
             this->searchWidget, SLOT(keyPressed(QKeyEvent*)));
     connect(this->searchWidget, SIGNAL(hideWindow()), this, SIGNAL(hideWindow()));
@@ -108,6 +197,18 @@ void TakeoffWidget::reset()
     this->setLayout(l);
 }
 
+void TakeoffWidget::repage()
+{
+    this->menuWidget->repage();
+    this->searchWidget->repage();
+}
+
+void TakeoffWidget::updateLaunchers()
+{
+    this->menuWidget->updateLaunchers();
+    this->searchWidget->updateLaunchers();
+}
+
 //------------------------------------------------------------------------------
 
 void TakeoffWidget::keyPressEvent(QKeyEvent *event)
@@ -174,12 +275,46 @@ void TakeoffWidget::keyPressEvent(QKeyEvent *event)
 void TakeoffWidget::paint(QPainter *painter,
             const QStyleOptionGraphicsItem */*option*/, QWidget */*widget*/)
 {
-    Config *cfg = Config::getInstance();
-    if (cfg->getSettings(Config::SHOW_BACKGROUND_IMAGE).toBool()) {
-        QPixmap img(cfg->getSettings(Config::BACKGROUND_IMAGE).toString());
-        QRect imgSize(0, 0, this->size().width(), this->size().height());
-        painter->drawImage(imgSize, img.toImage());
+    static bool firstPaint = true;
+    if (firstPaint) {
+        Trace::addInstant("TakeoffWidget::firstPaint");
+        firstPaint = false;
+    }
+
+    const Config::Values &cfg = Config::getInstance()->getValues();
+    if (!cfg.showBackgroundImage)
+        return;
+
+    const QString &path = cfg.backgroundImage;
+    QSize size = this->size().toSize();
+
+    if (path != this->backgroundPath) {
+        KDirWatch *watch = KDirWatch::self();
+        if (!this->backgroundPath.isEmpty())
+            watch->removeFile(this->backgroundPath);
+        if (!path.isEmpty())
+            watch->addFile(path);
     }
+
+    // Decode the image again only if it has changed, meanwhile the previous
+    // one is stretched
+    if (path != this->backgroundPath || this->backgroundDirty
+            || size != this->backgroundSize) {
+        this->backgroundPath  = path;
+        this->backgroundDirty = false;
+        this->backgroundSize  = size;
+        this->backgroundGeneration++;
+        this->backgroundPool->start(new BackgroundJob(this, path, size,
+                this->backgroundGeneration));
+    }
+
+    if (this->background.isNull())
+        return;
+
+    if (this->background.size() == size)
+        painter->drawPixmap(0, 0, this->background);
+    else
+        painter->drawPixmap(QRect(QPoint(0, 0), size), this->background);
 }
 
 
@@ -210,6 +345,25 @@ void TakeoffWidget::exitSearch()
     this->tabBar->setCurrentIndex(0);
 }
 
+void TakeoffWidget::backgroundLoaded(int generation, const QImage &image)
+{
+    // Discard the images of a previous path or size
+    if (generation != this->backgroundGeneration)
+        return;
+
+    this->background = QPixmap::fromImage(image);
+    this->update();
+}
+
+void TakeoffWidget::backgroundChanged(const QString &path)
+{
+    if (path != this->backgroundPath)
+        return;
+
+    this->backgroundDirty = true;
+    this->update();
+}
+
 #include <QDebug>
 void TakeoffWidget::reloadFavorites()
 {
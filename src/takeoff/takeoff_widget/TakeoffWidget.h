@@ -21,9 +21,14 @@
 #ifndef TAKEOFFWIDGET_TAKEOFFWIDGET_H
 #define TAKEOFFWIDGET_TAKEOFFWIDGET_H
 
+#include <QtCore/QSize>
+#include <QtCore/QString>
+#include <QtGui/QPixmap>
 #include <KDE/Plasma/Applet>
+class QImage;
+class QThreadPool;
 namespace Plasma         { class TabBar; }
-namespace Takeoff        { class Launcher; }
+namespace Takeoff        { struct LauncherData; }
 namespace TakeoffPrivate { class MenuWidget; class SearchWidget; }
 namespace Takeoff {
 
@@ -45,6 +50,11 @@ public:
      */
     TakeoffWidget(QGraphicsWidget *parent = 0);
 
+    /**
+     * Destructor. Waits until the background image is loaded.
+     */
+    virtual ~TakeoffWidget();
+
     //--------------------------------------------------------------------------
 
     /**
@@ -56,18 +66,48 @@ public:
     void addMenuCategory(const QIcon &icon, const QString &title);
 
     /**
-     * Adds a new launcher to the specified tab. If the index is incorrect or
-     * the launcher is NULL it won't effect.
+     * Adds a new tab whose launchers are created the first time it is shown.
+     * @param icon  The icon that will appear at the left of the title.
+     * @param title The text to display next to the icon.
+     * @param first Position in Menu::getAllApplications() of the first
+     *        application of the tab.
+     * @param count Number of applications of the tab.
+     */
+    void addLazyMenuCategory(const QIcon &icon, const QString &title,
+            int first, int count);
+
+    /**
+     * Adds a new launcher to the specified tab. If the index is incorrect it
+     * won't effect.
      * @param tabIndex The index of the tab where the launcher will be added.
      * @param launcher The launcher to add.
      */
-    void addMenuLauncher(int tabIndex, Launcher *launcher);
+    void addMenuLauncher(int tabIndex, const LauncherData &launcher);
+
+    /**
+     * Adds the launchers to the end of the specified tab, filling its panels
+     * at once. If the index is incorrect it won't effect.
+     * @param tabIndex  The index of the tab where the launchers will be added.
+     * @param launchers The launchers to add.
+     */
+    void addMenuLaunchers(int tabIndex, const QList<LauncherData> &launchers);
 
     /**
      * Reset the widget to the empty state.
      */
     void reset();
 
+    /**
+     * Places the launchers in panels of the configured size, without creating
+     * them again.
+     */
+    void repage();
+
+    /**
+     * Updates the launchers after a change in the configuration of their text.
+     */
+    void updateLaunchers();
+
     //--------------------------------------------------------------------------
 
     /**
@@ -82,7 +122,9 @@ public:
     virtual void contextMenuEvent(QGraphicsSceneContextMenuEvent *) {}
 
     /**
-     * Paints the background image, if any.
+     * Paints the background image, if any. The image is decoded and scaled in
+     * other thread the first time and whenever its path or the size of the
+     * widget change, or the file is modified.
      */
     virtual void paint(QPainter *painter,
             const QStyleOptionGraphicsItem *option, QWidget *widget);
@@ -108,11 +150,6 @@ signals:
      */
     void clicked() const;
 
-    /**
-     * Signal that is emitted when a launcher is added to favorites.
-     */
-    void addedToFavorites() const;
-
     /**
       * Signal that is emitted when a arrow key or the return is hit in the
       * menu tab
@@ -138,6 +175,20 @@ private slots:
     /// reloads the favorites
     void reloadFavorites();
 
+    /**
+     * Receives the background image decoded and scaled in other thread.
+     * @param generation Value of backgroundGeneration when the image was
+     *        requested.
+     * @param image      The scaled image, null if it couldn't be read.
+     */
+    void backgroundLoaded(int generation, const QImage &image);
+
+    /**
+     * Marks the background image to be decoded again when its file changes.
+     * @param path The changed file.
+     */
+    void backgroundChanged(const QString &path);
+
 private:
 
     /// Tab bar with the two different areas, the menu and the search area.
@@ -149,6 +200,24 @@ private:
     /// Widget with the search interface, placed on the second tab of tabBar.
     TakeoffPrivate::SearchWidget *searchWidget;
 
+    /// Background image, scaled to the size of the widget.
+    QPixmap background;
+
+    /// Path of the last requested background image.
+    QString backgroundPath;
+
+    /// If the file of the background image changed since it was requested.
+    bool backgroundDirty;
+
+    /// Size of the last requested background image.
+    QSize backgroundSize;
+
+    /// Thread where the background image is decoded.
+    QThreadPool *backgroundPool;
+
+    /// Incremented with each request to discard the outdated images.
+    int backgroundGeneration;
+
 };
 
 }      // End namespace
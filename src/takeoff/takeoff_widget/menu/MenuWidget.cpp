@@ -19,6 +19,7 @@
  * @class  TakeoffPrivate::MenuWidget
  */
 #include "MenuWidget.h"
+#include <QtCore/QTimer>
 #include <QtGui/QGraphicsLinearLayout>
 #include <QKeyEvent>
 #include <KDE/Plasma/TabBar>
@@ -26,19 +27,41 @@
 #include "../Launcher.h"
 #include "../../model/config/Config.h"
 #include "../../model/favorites/Favorites.h"
+#include "../../model/menu/Menu.h"
+#include "../../trace/Trace.h"
 using namespace TakeoffPrivate;
 
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/// Milliseconds without changing the tab to prepare the next ones.
+const int PREWARM_DELAY = 1000;
+
+}
+
+
 // ************************************************************************** //
 // **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
 // ************************************************************************** //
 
 MenuWidget::MenuWidget(QGraphicsWidget *parent)
         : QGraphicsWidget(parent),
-          menuBar(new Plasma::TabBar)
+          menuBar(new Plasma::TabBar),
+          prewarmTimer(new QTimer(this))
 {
     // Only show categories if more than one is available
     this->menuBar->setTabBarShown(false);
 
+    // The launchers of the categories are created when they are shown
+    this->prewarmTimer->setSingleShot(true);
+    this->prewarmTimer->setInterval(PREWARM_DELAY);
+    connect(this->prewarmTimer, SIGNAL(timeout()), this, SLOT(prewarm()));
+    connect(this->menuBar, SIGNAL(currentChanged(int)),
+            this, SLOT(tabChanged(int)));
+
     // Add the widget
     QGraphicsLinearLayout *l = new QGraphicsLinearLayout(this);
     l->addItem(this->menuBar);
@@ -54,10 +77,6 @@ void MenuWidget::addMenuCategory(const QIcon &icon, const QString &title)
     PanelArea *panelArea = new PanelArea(this);
 
     connect(panelArea, SIGNAL(clicked()), this, SIGNAL(clicked()));
-    connect(panelArea, SIGNAL(addedToFavorites()),
-            this, SIGNAL(addedToFavorites()));
-    connect(panelArea, SIGNAL(removedFromFavorites()),
-            this, SIGNAL(removedFromFavorites()));
     connect(this, SIGNAL(signalArrowPressed(QKeyEvent*)),
             panelArea, SLOT(slotArrowPressed(QKeyEvent*)));
 
@@ -68,34 +87,149 @@ void MenuWidget::addMenuCategory(const QIcon &icon, const QString &title)
         this->menuBar->setTabBarShown(true);
 }
 
-void MenuWidget::addMenuLauncher(int tabIndex, Takeoff::Launcher *launcher)
+void MenuWidget::addLazyMenuCategory(const QIcon &icon, const QString &title,
+        int first, int count)
+{
+    // Until it is shown the tab is an empty PanelArea
+    this->addMenuCategory(icon, title);
+
+    int index = this->menuBar->count()-1;
+    this->pendingCategories.insert(index, qMakePair(first, count));
+    if (index == this->menuBar->currentIndex())
+        this->loadCategory(index);
+}
+
+void MenuWidget::addMenuLauncher(int tabIndex,
+        const Takeoff::LauncherData &launcher)
 {
     // Add the launcher
     PanelArea *panelArea = (PanelArea*)this->menuBar->tabAt(tabIndex);
 
-    if (panelArea == NULL || launcher == NULL)
+    if (panelArea == NULL)
         return;
 
     panelArea->addLauncher(launcher);
 }
 
+void MenuWidget::addMenuLaunchers(int tabIndex,
+        const QList<Takeoff::LauncherData> &launchers)
+{
+    PanelArea *panelArea = (PanelArea*)this->menuBar->tabAt(tabIndex);
+    if (panelArea == NULL)
+        return;
+
+    panelArea->addLaunchers(launchers);
+}
+
 void MenuWidget::reloadFavorites()
 {
-    Config *cfg = Config::getInstance();
-    if (cfg->getSettings(Config::SHOW_FAVORITES).toBool()) {
+    TAKEOFF_TRACE_SPAN("MenuWidget::reloadFavorites");
+
+    if (Config::getInstance()->getValues().showFavorites) {
         PanelArea *panelArea = (PanelArea*)this->menuBar->tabAt(0);
         panelArea->removeAllLaunchers();
 
         Favorites *favorites = Favorites::getInstance();
-        QList<Takeoff::Launcher*> favoritesList = favorites->getFavorites();
+        panelArea->addLaunchers(favorites->getFavorites());
+    }
+}
+
+
+void MenuWidget::repage()
+{
+    for (int n=0; n<this->menuBar->count(); n++)
+        ((PanelArea*)this->menuBar->tabAt(n))->repage();
+}
+
+void MenuWidget::updateLaunchers()
+{
+    for (int n=0; n<this->menuBar->count(); n++)
+        ((PanelArea*)this->menuBar->tabAt(n))->updateLaunchers();
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC SLOTS                      ********** //
+// ************************************************************************** //
 
-        foreach (Takeoff::Launcher *launcher, favoritesList) {
-            this->addMenuLauncher(0, launcher);
+void MenuWidget::favoriteAdded(int index)
+{
+    if (!Config::getInstance()->getValues().showFavorites
+            || this->menuBar->count() == 0)
+        return;
+
+    PanelArea *panelArea = (PanelArea*)this->menuBar->tabAt(0);
+    panelArea->insertLauncher(index,
+            Favorites::getInstance()->getFavorite(index));
+}
+
+void MenuWidget::favoriteRemoved(int index)
+{
+    if (!Config::getInstance()->getValues().showFavorites
+            || this->menuBar->count() == 0)
+        return;
+
+    PanelArea *panelArea = (PanelArea*)this->menuBar->tabAt(0);
+    panelArea->removeLauncher(index);
+}
+
+
+// ************************************************************************** //
+// **********                    PRIVATE SLOTS                     ********** //
+// ************************************************************************** //
+
+void MenuWidget::tabChanged(int index)
+{
+    this->loadCategory(index);
+
+    if (Config::getInstance()->getValues().prewarmTabs
+            && !this->pendingCategories.isEmpty())
+        this->prewarmTimer->start();
+}
+
+void MenuWidget::prewarm()
+{
+    // The user usually moves to the next tab or goes back to the previous one
+    int current = this->menuBar->currentIndex();
+    int candidates[] = { current + 1, current - 1 };
+
+    for (uint n=0; n<sizeof(candidates)/sizeof(candidates[0]); n++) {
+        if (this->pendingCategories.contains(candidates[n])) {
+            this->loadCategory(candidates[n]);
+
+            // One tab at a time, to don't block the user
+            this->prewarmTimer->start();
+            return;
         }
     }
 }
 
 
+// ************************************************************************** //
+// **********                   PRIVATE METHODS                    ********** //
+// ************************************************************************** //
+
+void MenuWidget::loadCategory(int index)
+{
+    if (!this->pendingCategories.contains(index))
+        return;
+
+    TAKEOFF_TRACE_SPAN("MenuWidget::loadCategory");
+
+    QPair<int, int> range = this->pendingCategories.take(index);
+    PanelArea *panelArea = (PanelArea*)this->menuBar->tabAt(index);
+    QList<Takeoff::Launcher*> *allApplications =
+            Menu::getInstance()->getAllApplications();
+
+    QList<Takeoff::LauncherData> launchers;
+    launchers.reserve(range.second);
+    for (int n=range.first; n<range.first+range.second; n++)
+        launchers.append(allApplications->at(n)->getData());
+
+    panelArea->addLaunchers(launchers);
+}
+
+
 // ************************************************************************** //
 // **********                      GET/SET/IS                      ********** //
 // ************************************************************************** //
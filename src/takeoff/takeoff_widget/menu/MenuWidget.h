@@ -21,10 +21,13 @@
 #ifndef TAKEOFFWIDGET_PARTS_PANEL_H
 #define TAKEOFFWIDGET_PARTS_PANEL_H
 
+#include <QtCore/QHash>
+#include <QtCore/QPair>
 #include <QtGui/QGraphicsWidget>
 class QGraphicsGridLayout;
+class QTimer;
 namespace Plasma  { class TabBar; }
-namespace Takeoff { class Launcher; }
+namespace Takeoff { struct LauncherData; }
 namespace TakeoffPrivate  {
 
 /**
@@ -54,18 +57,48 @@ public:
     void addMenuCategory(const QIcon &icon, const QString &title);
 
     /**
-     * Adds a new launcher to the specified tab. If the index is incorrect or
-     * the launcher is NULL it won't effect.
+     * Adds a new tab whose launchers are created the first time it is shown.
+     * @param icon  The icon that will appear at the left of the title.
+     * @param title The text to display next to the icon.
+     * @param first Position in Menu::getAllApplications() of the first
+     *        application of the tab.
+     * @param count Number of applications of the tab.
+     */
+    void addLazyMenuCategory(const QIcon &icon, const QString &title,
+            int first, int count);
+
+    /**
+     * Adds a new launcher to the specified tab. If the index is incorrect it
+     * won't effect.
      * @param tabIndex The index of the tab where the launcher will be added.
      * @param launcher The launcher to add.
      */
-    void addMenuLauncher(int tabIndex, Takeoff::Launcher *launcher);
+    void addMenuLauncher(int tabIndex, const Takeoff::LauncherData &launcher);
+
+    /**
+     * Adds the launchers to the end of the specified tab, filling its panels
+     * at once. If the index is incorrect it won't effect.
+     * @param tabIndex  The index of the tab where the launchers will be added.
+     * @param launchers The launchers to add.
+     */
+    void addMenuLaunchers(int tabIndex,
+            const QList<Takeoff::LauncherData> &launchers);
 
     /**
      * Reloads the favorites.
      */
     void reloadFavorites();
 
+    /**
+     * Places the launchers of every category in panels of the configured size.
+     */
+    void repage();
+
+    /**
+     * Updates the text of all the launchers after a configuration change.
+     */
+    void updateLaunchers();
+
     //--------------------------------------------------------------------------
 
     /**
@@ -96,28 +129,42 @@ public:
 
 public slots:
 
+    /**
+     * Adds the new favorite to the favorites tab.
+     * @param index The position of the favorite.
+     */
+    void favoriteAdded(int index);
+
+    /**
+     * Removes a favorite from the favorites tab.
+     * @param index The position of the favorite.
+     */
+    void favoriteRemoved(int index);
+
     /**
       * Handle Enter/Return and arrow keys
       * @param event Keyboard event
       */
     void keyPressed(QKeyEvent* event);
 
-signals:
+private slots:
 
     /**
-     * Signal that is emitted whenever the user click on one launcher.
+     * Creates the launchers of the shown tab and schedules the preparation of
+     * the tabs next to it.
+     * @param index The index of the shown tab.
      */
-    void clicked() const;
+    void tabChanged(int index);
 
-    /**
-     * Signal that is emitted when a launcher is added to favorites.
-     */
-    void addedToFavorites() const;
+    /// Creates the launchers of a tab next to the current one.
+    void prewarm();
+
+signals:
 
     /**
-     * Signal that is emitted when a launcher is removed from favorites.
+     * Signal that is emitted whenever the user click on one launcher.
      */
-    void removedFromFavorites() const;
+    void clicked() const;
 
     /**
       * Signal that is emitted when Enter/Return or an arrow key is pressed
@@ -126,9 +173,23 @@ signals:
 
 private:
 
+    /**
+     * Creates the launchers of the specified tab, if they aren't created yet.
+     * @param index The index of the tab.
+     */
+    void loadCategory(int index);
+
+    //--------------------------------------------------------------------------
+
     /// Tab bar to show the different menu launchers and categories.
     Plasma::TabBar *menuBar;
 
+    /// Applications (first, count) of the tabs whose launchers aren't created.
+    QHash< int, QPair<int, int> > pendingCategories;
+
+    /// Waits for the user to be idle to prepare the next tabs.
+    QTimer *prewarmTimer;
+
 };
 
 }      // End namespace
@@ -29,7 +29,9 @@
 #include <KDE/Plasma/TabBar>
 #include <KDE/Plasma/FrameSvg>
 #include "../Launcher.h"
+#include "../util/LauncherGrid.h"
 #include "../util/Panel.h"
+#include "../../model/config/Config.h"
 using namespace Takeoff;
 using namespace TakeoffPrivate;
 
@@ -40,7 +42,8 @@ using namespace TakeoffPrivate;
 PanelArea::PanelArea(QGraphicsWidget *parent)
         : QGraphicsWidget(parent),
           panelTabBar(new Plasma::TabBar(this)),
-          panelSelector(new Plasma::TabBar(this))
+          panelSelector(new Plasma::TabBar(this)),
+          staleFrom(-1)
 {
     // TODO For the moment Plasma::TabBar don't allow RoundedSouth (line 183 in
     //      http://api.kde.org/4.x-api/kdelibs-apidocs/plasma/html/tabbar_8cpp_source.html)
@@ -61,6 +64,8 @@ PanelArea::PanelArea(QGraphicsWidget *parent)
 
     connect(this->panelSelector, SIGNAL(currentChanged(int)),
             this->panelTabBar, SLOT(setCurrentIndex(int)));
+    connect(this->panelTabBar, SIGNAL(currentChanged(int)),
+            this, SLOT(refreshPanel(int)));
 
     QGraphicsGridLayout *l = new QGraphicsGridLayout(this);
     Plasma::Label *separator1 = new Plasma::Label;
@@ -73,6 +78,9 @@ PanelArea::PanelArea(QGraphicsWidget *parent)
     l->addItem(separator2, 1, 2);
     this->setLayout(l);
     //}
+
+    const Config::Values &cfg = Config::getInstance()->getValues();
+    this->panelSize = qMax(1, cfg.numRows * cfg.numColumns);
 }
 
 
@@ -80,72 +88,271 @@ PanelArea::PanelArea(QGraphicsWidget *parent)
 // **********                   PRIVATE METHODS                    ********** //
 // ************************************************************************** //
 
-void PanelArea::addPanel()
+AbstractPanel *PanelArea::createPanel()
 {
-    Panel *newPanel = new Panel(this);
+    AbstractPanel *newPanel;
+    if (Config::getInstance()->getValues().singlePainterGrid)
+        newPanel = new LauncherGrid(this);
+    else
+        newPanel = new Panel(this);
+
     connect(newPanel, SIGNAL(clicked()), this, SIGNAL(clicked()));
-    connect(newPanel, SIGNAL(addedToFavorites()),
-            this, SIGNAL(addedToFavorites()));
-    connect(newPanel, SIGNAL(removedFromFavorites()),
-            this, SIGNAL(removedFromFavorites()));
 
-    this->panelTabBar->addTab("", newPanel);
+    return newPanel;
+}
+
+void PanelArea::addPanel(AbstractPanel *panel)
+{
+    this->panelTabBar->addTab("", panel);
     this->panelSelector->addTab(
             QString::number(this->panelTabBar->count()));
 }
 
+void PanelArea::updatePanelSelector()
+{
+    // Only show the selection bar if there are more than one panel
+    this->panelSelector->setTabBarShown(this->panelTabBar->count() > 1);
+
+    // Resize the bar
+    ((QGraphicsGridLayout*)this->layout())->setColumnMaximumWidth(1,
+            this->panelTabBar->count()*50);
+}
+
+void PanelArea::removeLastPanel()
+{
+    int last = this->panelTabBar->count()-1;
+    AbstractPanel *panel = (AbstractPanel*)this->panelTabBar->tabAt(last);
+    this->panelTabBar->removeTab(last);
+    this->panelSelector->removeTab(last);
+
+    // The panel could be handling the current event, see removeLauncher()
+    panel->hide();
+    panel->deleteLater();
+    this->refreshedPanels.remove(last);
+
+    this->updatePanelSelector();
+}
+
+void PanelArea::updateNumPanels()
+{
+    int count = (this->launchers.length() + this->panelSize - 1)
+            / this->panelSize;
+
+    if (this->panelTabBar->count() == count)
+        return;
+
+    while (this->panelTabBar->count() < count)
+        this->addPanel(this->createPanel());
+    while (this->panelTabBar->count() > count)
+        this->removeLastPanel();
+
+    this->updatePanelSelector();
+}
+
+void PanelArea::invalidatePanels(int from)
+{
+    if (this->staleFrom == -1 || from < this->staleFrom)
+        this->staleFrom = from;
+
+    QMutableSetIterator<int> it(this->refreshedPanels);
+    while (it.hasNext()) {
+        if (it.next() >= from)
+            it.remove();
+    }
+}
+
+bool PanelArea::isStale(int index) const
+{
+    return this->staleFrom != -1 && index >= this->staleFrom
+            && !this->refreshedPanels.contains(index);
+}
+
 // ************************************************************************** //
 // **********                    PUBLIC METHODS                    ********** //
 // ************************************************************************** //
 
-void PanelArea::addLauncher(Launcher *launcher)
+void PanelArea::addLauncher(const LauncherData &launcher)
+{
+    this->addLaunchers(QList<LauncherData>() << launcher);
+}
+
+void PanelArea::addLaunchers(const QList<LauncherData> &launchers)
+{
+    int first = this->launchers.length();
+    this->launchers.append(launchers);
+
+    // Fill the free cells of the last panel, unless it is filled again later
+    int added = 0;
+    int count = this->panelTabBar->count();
+    if (count > 0 && !this->isStale(count-1)) {
+        AbstractPanel *lastPanel = (AbstractPanel*)this->panelTabBar->tabAt(
+                count-1);
+        added = lastPanel->addLaunchers(launchers.mid(0,
+                count * this->panelSize - first));
+    } else if (count > 0) {
+        added = count * this->panelSize - first;
+    }
+
+    if (added >= launchers.length())
+        return;
+
+    // The new panels are filled before adding them to the tab bar, so their
+    // layouts don't invalidate the layouts of the PanelArea for each launcher
+    while (added < launchers.length()) {
+        AbstractPanel *newPanel = this->createPanel();
+        newPanel->addLaunchers(launchers.mid(added, this->panelSize));
+        this->addPanel(newPanel);
+
+        if (this->staleFrom != -1)
+            this->refreshedPanels.insert(this->panelTabBar->count()-1);
+        added += this->panelSize;
+    }
+
+    this->updatePanelSelector();
+}
+
+void PanelArea::insertLauncher(int index, const LauncherData &launcher)
 {
-    // If the panel area is empty add a new panel
-    if (this->panelTabBar->count() == 0)
-        this->addPanel();
+    if (index < 0 || index > this->launchers.length())
+        index = this->launchers.length();
+    this->launchers.insert(index, launcher);
 
-    Panel *lastPanel = (Panel*)this->panelTabBar->tabAt(
-            this->panelTabBar->count()-1);
+    // Only the panel of the launcher changes now, its last launcher goes to
+    // the next panel, that is filled again when it is shown
+    int panelIndex = index / this->panelSize;
+    int from = panelIndex;
+    if (panelIndex < this->panelTabBar->count() && !this->isStale(panelIndex)) {
+        AbstractPanel *panel =
+                (AbstractPanel*)this->panelTabBar->tabAt(panelIndex);
+        if (panel->isFull())
+            panel->takeLauncher(panel->getNumLaunchers()-1);
 
-    // If the panel is NOT full add the launcher
-    if (!lastPanel->isFull()) {
-        lastPanel->addLauncher(launcher);
+        panel->insertLauncher(index % this->panelSize, launcher);
+        from++;
+    }
 
-    // If the panel is full create a new panel to add the launcher
-    } else {
-        // Add a new panel
-        this->addPanel();
+    this->invalidatePanels(from);
+    this->updateNumPanels();
+    this->refreshPanel(this->panelTabBar->currentIndex());
+}
 
-        // Add the launcher to the new panel
-        Panel *lastPanel = (Panel*)this->panelTabBar->tabAt(
-                this->panelTabBar->count()-1);
-        lastPanel->addLauncher(launcher);
+void PanelArea::removeLauncher(int index)
+{
+    if (index < 0 || index >= this->launchers.length())
+        return;
+    this->launchers.removeAt(index);
 
-        // Show the selection bar
-        this->panelSelector->setTabBarShown(true);
+    // Like insertLauncher(), the first launcher of the next panel fills the
+    // hole and the next panels are filled again when they are shown
+    int panelIndex = index / this->panelSize;
+    int from = panelIndex;
+    if (!this->isStale(panelIndex)) {
+        AbstractPanel *panel =
+                (AbstractPanel*)this->panelTabBar->tabAt(panelIndex);
+        panel->takeLauncher(index % this->panelSize);
 
-        // Resize the bar
-        ((QGraphicsGridLayout*)this->layout())->setColumnMaximumWidth(1,
-                this->panelTabBar->count()*50);
+        int next = (panelIndex + 1) * this->panelSize - 1;
+        if (next < this->launchers.length())
+            panel->addLauncher(this->launchers.at(next));
+        from++;
     }
+
+    this->invalidatePanels(from);
+    this->updateNumPanels();
+    this->refreshPanel(this->panelTabBar->currentIndex());
 }
 
 void PanelArea::removeAllLaunchers()
 {
     int count = this->panelTabBar->count()-1;
     for (int n=count; n>=0; n--) {
-        Panel *panel = (Panel*)this->panelTabBar->tabAt(n);
+        AbstractPanel *panel = (AbstractPanel*)this->panelTabBar->tabAt(n);
         this->panelTabBar->removeTab(n);
         this->panelSelector->removeTab(n);
         delete panel;
     }
 
+    this->launchers.clear();
+    this->staleFrom = -1;
+    this->refreshedPanels.clear();
+
     this->panelTabBar->setTabBarShown(false);
     this->panelSelector->setTabBarShown(false);
 }
 
+void PanelArea::repage()
+{
+    QList<LauncherData> launchers = this->launchers;
+    this->removeAllLaunchers();
+
+    const Config::Values &cfg = Config::getInstance()->getValues();
+    this->panelSize = qMax(1, cfg.numRows * cfg.numColumns);
+    this->addLaunchers(launchers);
+}
+
+void PanelArea::updateLaunchers()
+{
+    for (int n=0; n<this->panelTabBar->count(); n++) {
+        AbstractPanel *panel = (AbstractPanel*)this->panelTabBar->tabAt(n);
+        panel->updateLaunchers();
+        panel->update();
+    }
+}
+
+void PanelArea::setCurrentPanel(int index)
+{
+    this->panelSelector->setCurrentIndex(index);
+    this->panelTabBar->setCurrentIndex(index);
+    this->refreshPanel(index);
+}
+
 void PanelArea::slotArrowPressed(QKeyEvent *event)
 {
-    Panel* panel = dynamic_cast<Panel*>(panelTabBar->tabAt(panelTabBar->currentIndex()));
-    panel->keyPressed(event);
+    AbstractPanel* panel = dynamic_cast<AbstractPanel*>(panelTabBar->tabAt(panelTabBar->currentIndex()));
+    if (panel != NULL && panel->getNumLaunchers() > 0)
+        panel->keyPressed(event);
+}
+
+
+// ************************************************************************** //
+// **********                    PRIVATE SLOTS                     ********** //
+// ************************************************************************** //
+
+void PanelArea::refreshPanel(int index)
+{
+    if (index < 0 || index >= this->panelTabBar->count()
+            || !this->isStale(index))
+        return;
+
+    AbstractPanel *panel = (AbstractPanel*)this->panelTabBar->tabAt(index);
+    panel->takeAllLaunchers();
+    panel->addLaunchers(this->launchers.mid(index * this->panelSize,
+            this->panelSize));
+    this->refreshedPanels.insert(index);
+}
+
+
+// ************************************************************************** //
+// **********                      GET/SET/IS                      ********** //
+// ************************************************************************** //
+
+QString PanelArea::getDesktopFile(int index) const
+{
+    if (index < 0 || index >= this->launchers.length())
+        return QString();
+
+    return this->launchers.at(index).desktopFile;
+}
+
+int PanelArea::getNumPanels() const
+{
+    return this->panelTabBar->count();
+}
+
+AbstractPanel *PanelArea::getPanel(int index) const
+{
+    if (index < 0 || index >= this->panelTabBar->count())
+        return NULL;
+
+    return (AbstractPanel*)this->panelTabBar->tabAt(index);
 }
@@ -21,16 +21,24 @@
 #ifndef TAKEOFFWIDGET_PARTS_PANELAREA_H
 #define TAKEOFFWIDGET_PARTS_PANELAREA_H
 
+#include <QtCore/QList>
+#include <QtCore/QSet>
 #include <QtGui/QGraphicsWidget>
-namespace Takeoff { class Launcher; }
+#include "../Launcher.h"
 namespace Plasma  { class TabBar; }
 namespace TakeoffPrivate {
+class AbstractPanel;
 
 /**
  * Widget that contains one or more panels. The panels are responsible of show
  * the launchers, if a panel is complete (not allow to show more launchers) the
  * panel area will add to itself other panel to show more launchers and provide
  * a method and animations to change between panels.
+ *
+ * The area keeps the list of all its launchers and each panel shows a page of
+ * it. When a launcher is inserted or removed only the panel that contains it
+ * is changed, the next panels are filled again when they are shown, so the
+ * cost doesn't depend on the number of launchers.
  */
 class PanelArea : public QGraphicsWidget
 {
@@ -51,29 +59,84 @@ public:
      * is full, adds a new Panel to add the Launcher.
      * @param launcher The launcher to add.
      */
-    void addLauncher(Takeoff::Launcher *launcher);
+    void addLauncher(const Takeoff::LauncherData &launcher);
+
+    /**
+     * Adds the launchers to the end, in order. The panels are filled and added
+     * at once, so it is faster than calling addLauncher() for each launcher.
+     * @param launchers The launchers to add.
+     */
+    void addLaunchers(const QList<Takeoff::LauncherData> &launchers);
+
+    /**
+     * Inserts a launcher at the specified position. Only the panel that
+     * contains the position is changed, the next ones are updated when they
+     * are shown. A panel is added if the last one overflows.
+     * @param index    The position, counting from the first panel.
+     * @param launcher The launcher to insert.
+     */
+    void insertLauncher(int index, const Takeoff::LauncherData &launcher);
+
+    /**
+     * Removes the launcher at the specified position. Like insertLauncher(),
+     * the next panels are updated when they are shown. The last panel is
+     * removed if it gets empty.
+     * @param index The position, counting from the first panel.
+     */
+    void removeLauncher(int index);
 
     /**
      * Removes all the launchers.
      */
     void removeAllLaunchers();
 
-signals:
+    /**
+     * Places the launchers again in panels of the configured size and kind.
+     * The data of the launchers is moved, the panels create the widgets they
+     * need.
+     */
+    void repage();
 
     /**
-     * Signal that is emitted whenever the user click on one launcher.
+     * Updates the text of all the launchers after a configuration change.
      */
-    void clicked() const;
+    void updateLaunchers();
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Returns the desktop file of the specified launcher.
+     * @param  index The index of the launcher, counting from the first panel.
+     * @return The desktop file or an empty string if the launcher is not
+     *         available.
+     */
+    QString getDesktopFile(int index) const;
+
+    /**
+     * Returns the number of panels.
+     * @return The number of panels.
+     */
+    int getNumPanels() const;
 
     /**
-     * Signal that is emitted when a launcher is added to favorites.
+     * Returns the specified panel.
+     * @param  index The index of the panel.
+     * @return The panel or NULL if it doesn't exist.
      */
-    void addedToFavorites() const;
+    AbstractPanel *getPanel(int index) const;
+
+    /**
+     * Shows the specified panel, filling it first if needed.
+     * @param index The index of the panel.
+     */
+    void setCurrentPanel(int index);
+
+signals:
 
     /**
-     * Signal that is emitted when a launcher is removed from favorites.
+     * Signal that is emitted whenever the user click on one launcher.
      */
-    void removedFromFavorites() const;
+    void clicked() const;
 
 public slots:
 
@@ -83,12 +146,60 @@ public slots:
       */
     void slotArrowPressed(QKeyEvent* event);
 
+private slots:
+
+    /**
+     * Fills the specified panel again if the launchers it shows changed since
+     * it was filled. Called when a panel is shown.
+     * @param index The index of the panel.
+     */
+    void refreshPanel(int index);
+
 private:
 
     /**
-     * Adds a new empty panel to the panel area.
+     * Creates a new empty panel, of the configured kind, without adding it to
+     * the panel area.
+     * @return The panel.
+     */
+    AbstractPanel *createPanel();
+
+    /**
+     * Adds a panel to the end of the panel area.
+     * @param panel The panel to add.
+     */
+    void addPanel(AbstractPanel *panel);
+
+    /**
+     * Shows the panel selector if there are more than one panel and resizes
+     * it.
+     */
+    void updatePanelSelector();
+
+    /**
+     * Removes the last panel and deletes it when control returns to the event
+     * loop.
+     */
+    void removeLastPanel();
+
+    /**
+     * Adds or removes panels at the end, so there are enough to show all the
+     * launchers. The added panels are empty until they are refreshed.
+     */
+    void updateNumPanels();
+
+    /**
+     * Marks the panels from the specified one as out of date.
+     * @param from Index of the first panel to refresh.
      */
-    void addPanel();
+    void invalidatePanels(int from);
+
+    /**
+     * Indicates if the launchers of a panel changed since it was filled.
+     * @param  index The index of the panel.
+     * @return If the panel must be refreshed.
+     */
+    bool isStale(int index) const;
 
     //--------------------------------------------------------------------------
 
@@ -98,6 +209,18 @@ private:
     /// TabBar to HACK the problem with the place of Plasma::TabBar
     Plasma::TabBar *panelSelector;
 
+    /// All the launchers of the area, in order.
+    QList<Takeoff::LauncherData> launchers;
+
+    /// Number of launchers of each panel.
+    int panelSize;
+
+    /// First panel that may be out of date, -1 if all are up to date.
+    int staleFrom;
+
+    /// Panels after staleFrom that were filled again since they changed.
+    QSet<int> refreshedPanels;
+
 };
 
 }      // End namespace
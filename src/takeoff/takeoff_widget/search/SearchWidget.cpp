@@ -19,15 +19,110 @@
  * @class  TakeoffPrivate::SearchWidget
  */
 #include "SearchWidget.h"
+#include <math.h>
+#include <QtCore/QMetaType>
+#include <QtCore/QRunnable>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
 #include <QtGui/QGraphicsGridLayout>
 #include <KDE/KIcon>
 #include <KDE/Plasma/IconWidget>
 #include <KDE/Plasma/LineEdit>
-#include "../util/Panel.h"
+#include "../menu/PanelArea.h"
 #include "../Launcher.h"
+#include "../../model/config/Config.h"
+#include "../../model/history/LaunchHistory.h"
 #include "../../model/menu/Menu.h"
+#include "../../model/search/SearchIndex.h"
+#include "../../metrics/Metrics.h"
+#include "../../trace/Trace.h"
 using namespace TakeoffPrivate;
 
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/**
+ * Search executed in the search thread. Only the positions of the results are
+ * sent to the SearchWidget, that creates their launchers one panel at a time.
+ */
+class SearchJob : public QRunnable
+{
+public:
+    SearchJob(SearchWidget *searchWidget, QSharedPointer<SearchIndex> index,
+            const QString &text, const QHash<int, int> &boosts,
+            const QAtomicInt *currentGeneration, int generation)
+            : searchWidget(searchWidget),
+              index(index),
+              text(text),
+              boosts(boosts),
+              currentGeneration(currentGeneration),
+              generation(generation)
+    {
+
+    }
+
+    virtual void run()
+    {
+        // Skip the searches cancelled while waiting in the queue
+        if (!this->isCurrent())
+            return;
+
+        TAKEOFF_TRACE_SPAN("SearchIndex::search");
+
+        QList<int> results = this->index->search(this->text, this->boosts,
+                this->currentGeneration, this->generation);
+        if (!this->isCurrent())
+            return;
+
+        // The results are sent even if there are none, so the widget knows
+        // that the search has finished
+        Metrics::record(Metrics::SEARCH_RESULTS, results.length());
+        QMetaObject::invokeMethod(this->searchWidget, "setResults",
+                Qt::QueuedConnection,
+                Q_ARG(int, this->generation),
+                Q_ARG(QList<int>, results));
+    }
+
+private:
+    bool isCurrent() const
+    {
+        return int(*this->currentGeneration) == this->generation;
+    }
+
+    SearchWidget *searchWidget;
+    QSharedPointer<SearchIndex> index;
+    QString text;
+    QHash<int, int> boosts;
+    const QAtomicInt *currentGeneration;
+    int generation;
+};
+
+/**
+ * Returns the relevance to add to the search results of each application
+ * according to its frecency. A launch adds a quarter of a match in the name, so
+ * the text of the search remains the most important.
+ */
+QHash<int, int> getFrecencyBoosts(const Menu *menu)
+{
+    QHash<int, int> boosts;
+    QHash<QString, double> scores = LaunchHistory::getInstance()->getScores();
+    QHashIterator<QString, double> it(scores);
+    while (it.hasNext()) {
+        it.next();
+        int id = menu->getApplicationIndex(it.key());
+        if (id != -1)
+            boosts.insert(id, qRound(4 * log(1 + it.value()) / log(2.0)));
+    }
+
+    return boosts;
+}
+
+}
+
 // ************************************************************************** //
 // **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
 // ************************************************************************** //
@@ -36,8 +131,16 @@ SearchWidget::SearchWidget(QGraphicsWidget *parent)
         : QGraphicsWidget(parent),
           goBack(new Plasma::IconWidget(this)),
           searchBox(new Plasma::LineEdit(this)),
-          resultsPanel(new Panel(this))
+          resultsArea(new PanelArea(this)),
+          searchPool(new QThreadPool(this)),
+          searchGeneration(0),
+          searchPending(false),
+          boostsValid(false)
 {
+    // The results are sent from the search thread
+    qRegisterMetaType< QList<int> >("QList<int>");
+    this->searchPool->setMaxThreadCount(1);
+
     // Set widgets properties
     this->goBack->setIcon("arrow-left");
     this->goBack->setMaximumIconSize(QSizeF(24, 24));
@@ -49,20 +152,23 @@ SearchWidget::SearchWidget(QGraphicsWidget *parent)
     connect(this->searchBox, SIGNAL(textChanged(QString)),
             this, SLOT(search(QString)));
 
-    connect(this->resultsPanel, SIGNAL(clicked()), this, SIGNAL(clicked()));
-    connect(this->resultsPanel, SIGNAL(addedToFavorites()),
-            this, SIGNAL(addedToFavorites()));
-    connect(this->resultsPanel, SIGNAL(removedFromFavorites()),
-            this, SIGNAL(removedFromFavorites()));
+    connect(this->resultsArea, SIGNAL(clicked()), this, SIGNAL(clicked()));
 
     // Add the widgets
     QGraphicsGridLayout *l = new QGraphicsGridLayout(this);
     l->addItem(this->goBack, 0, 0);
     l->addItem(this->searchBox, 0, 1);
-    l->addItem(resultsPanel, 1, 0, 1, 2);
+    l->addItem(resultsArea, 1, 0, 1, 2);
     this->setLayout(l);
 }
 
+SearchWidget::~SearchWidget()
+{
+    // The search job uses this widget, cancel it and wait until it finishes
+    this->searchGeneration.fetchAndAddOrdered(1);
+    this->searchPool->waitForDone();
+}
+
 
 // ************************************************************************** //
 // **********                     PRIVATE SLOTS                    ********** //
@@ -70,35 +176,81 @@ SearchWidget::SearchWidget(QGraphicsWidget *parent)
 
 void SearchWidget::search(const QString &text)
 {
-    // Remove all the current launchers
-    this->resultsPanel->removeAllLaunchers();
+    TAKEOFF_TRACE_SPAN("SearchWidget::search");
+
+    // Cancel the previous search and remove its results
+    int generation = this->searchGeneration.fetchAndAddOrdered(1) + 1;
+    this->resultsArea->removeAllLaunchers();
+    this->pendingResults.clear();
 
-    if (text.length() < 2 || text.trimmed().isEmpty())
+    if (this->searchPending)
+        Metrics::add(Metrics::SEARCHES_CANCELLED);
+    this->searchPending = false;
+
+    // The search session ends when the text is removed, the next one takes
+    // the launches done meanwhile into account
+    if (text.length() < 2 || text.trimmed().isEmpty()) {
+        this->boostsValid = false;
         return;
+    }
+
+    this->searchTimer.start();
+    this->searchPending = true;
 
-    // Get all the applications
     Menu *menu = Menu::getInstance();
-    QList<Takeoff::Launcher*> *apps = menu->getAllApplications();
+    if (!this->boostsValid) {
+        this->boosts = getFrecencyBoosts(menu);
+        this->boostsValid = true;
+    }
 
-    // Prepare the regular expression to find matches
-    QRegExp reg("*" + text.toLower() + "*");
-    reg.setPatternSyntax(QRegExp::Wildcard);
+    this->searchPool->start(new SearchJob(this, menu->getSearchIndex(), text,
+            this->boosts, &this->searchGeneration, generation));
+}
 
-    int n = 0;
-    while (n<apps->length() && !this->resultsPanel->isFull()) {
-        Takeoff::Launcher launcher = *(apps->at(n));
-        QString name = launcher.getName().toLower();
+void SearchWidget::setResults(int generation, const QList<int> &results)
+{
+    if (generation != int(this->searchGeneration))
+        return;
 
-        // If the application match with the search
-        if (reg.exactMatch(name)) {
-            Takeoff::Launcher *aux = new Takeoff::Launcher(launcher);
-            this->resultsPanel->addLauncher(aux);
-        }
+    this->pendingResults = results;
+    this->addNextResults();
 
-        n++;
+    // Latency from the keystroke until the first results are shown
+    if (this->searchPending) {
+        Metrics::record(Metrics::SEARCH_LATENCY,
+                this->searchTimer.nsecsElapsed() / 1000);
+        this->searchPending = false;
     }
 }
 
+void SearchWidget::addNextResults()
+{
+    if (this->pendingResults.isEmpty())
+        return;
+
+    TAKEOFF_TRACE_SPAN("SearchWidget::addNextResults");
+
+    const Config::Values &cfg = Config::getInstance()->getValues();
+    int panelSize = cfg.numRows * cfg.numColumns;
+
+    QList<Takeoff::Launcher*> *apps = Menu::getInstance()->getAllApplications();
+    QList<Takeoff::LauncherData> launchers;
+    int count = qMin(panelSize, this->pendingResults.length());
+    for (int n=0; n<count; n++) {
+        int id = this->pendingResults.at(n);
+        if (id < apps->length())
+            launchers.append(apps->at(id)->getData());
+    }
+    this->pendingResults = this->pendingResults.mid(count);
+
+    this->resultsArea->addLaunchers(launchers);
+
+    // The next panel is created once the pending events, like the key
+    // presses, are processed
+    if (!this->pendingResults.isEmpty())
+        QTimer::singleShot(0, this, SLOT(addNextResults()));
+}
+
 
 // ************************************************************************** //
 // **********                    PUBLIC METHODS                    ********** //
@@ -108,9 +260,9 @@ void SearchWidget::addSearchText(QKeyEvent *event)
 {
     if (event->key() == Qt::Key_Enter || event->key() == Qt::Key_Return) {
         emit this->clicked();
-        Takeoff::Launcher *launcher = this->resultsPanel->getLauncher(0);
-        if (launcher != NULL)
-            launcher->runApplication();
+        QString desktopFile = this->resultsArea->getDesktopFile(0);
+        if (!desktopFile.isEmpty())
+            Takeoff::Launcher::runApplication(desktopFile);
 
     } else if (event->key() == Qt::Key_Backspace)
         this->searchBox->setText(this->searchBox->text().mid(
@@ -122,12 +274,24 @@ void SearchWidget::addSearchText(QKeyEvent *event)
 void SearchWidget::clearSearchText()
 {
     this->searchBox->setText("");
-    this->resultsPanel->removeAllLaunchers();
+    this->resultsArea->removeAllLaunchers();
+    this->pendingResults.clear();
+    this->boostsValid = false;
+}
+
+void SearchWidget::repage()
+{
+    this->resultsArea->repage();
+}
+
+void SearchWidget::updateLaunchers()
+{
+    this->resultsArea->updateLaunchers();
 }
 
 void SearchWidget::keyPressed(QKeyEvent *event)
 {
-    this->resultsPanel->keyPressed(event);
+    this->resultsArea->slotArrowPressed(event);
     if (event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter)
         emit hideWindow();
 }
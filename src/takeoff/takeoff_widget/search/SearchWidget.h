@@ -21,8 +21,13 @@
 #ifndef TAKEOFFWIDGET_SEARCH_POPUPWINDOW_H
 #define TAKEOFFWIDGET_SEARCH_POPUPWINDOW_H
 
+#include <QtCore/QAtomicInt>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtGui/QGraphicsWidget>
-namespace TakeoffPrivate  { class Panel; }
+class QThreadPool;
+namespace TakeoffPrivate  { class PanelArea; }
 namespace Plasma          { class IconWidget; class LineEdit; }
 namespace TakeoffPrivate  {
 
@@ -41,6 +46,11 @@ public:
      */
     SearchWidget(QGraphicsWidget *parent = 0);
 
+    /**
+     * Destructor. Cancels the running search and waits until it finishes.
+     */
+    virtual ~SearchWidget();
+
     //--------------------------------------------------------------------------
 
     /**
@@ -54,6 +64,16 @@ public:
      */
     void clearSearchText();
 
+    /**
+     * Places the results in panels of the configured size.
+     */
+    void repage();
+
+    /**
+     * Updates the text of the results after a configuration change.
+     */
+    void updateLaunchers();
+
 public slots:
 
     void keyPressed(QKeyEvent* event);
@@ -61,32 +81,39 @@ public slots:
 private slots:
 
     /**
-     * Called whenever the search text change.
+     * Called whenever the search text change. Cancels the previous search and
+     * starts a new one in the search thread.
      * @param text The text to search
      */
     void search(const QString &text);
 
-signals:
-
     /**
-     * Signal that is emitted whenever the user click in the go back button.
+     * Called from the search thread with the results of a search. Only the
+     * first panel is created, see addNextResults(). The results of cancelled
+     * searches are ignored.
+     * @param generation The search that found the results.
+     * @param results    Positions of the results in Menu::getAllApplications().
      */
-    void exitSearch();
+    void setResults(int generation, const QList<int> &results);
 
     /**
-     * Signal that is emited whenever the user click in a launcher.
+     * Creates the launchers of the next panel of results. The following panel
+     * is created once the pending events are processed, so the key presses
+     * never wait for the launchers of a long list of results.
      */
-    void clicked();
+    void addNextResults();
+
+signals:
 
     /**
-     * Signal that is emitted when a launcher is added to favorites.
+     * Signal that is emitted whenever the user click in the go back button.
      */
-    void addedToFavorites() const;
+    void exitSearch();
 
     /**
-     * Signal that is emitted when a launcher is removed from favorites.
+     * Signal that is emited whenever the user click in a launcher.
      */
-    void removedFromFavorites() const;
+    void clicked();
 
     void hideWindow();
 
@@ -99,7 +126,28 @@ private:
     Plasma::LineEdit *searchBox;
 
     /// Widget to show the search results
-    Panel *resultsPanel;
+    PanelArea *resultsArea;
+
+    /// Thread where the searches are done, one at a time.
+    QThreadPool *searchPool;
+
+    /// Identifier of the current search. Incremented to cancel a search.
+    QAtomicInt searchGeneration;
+
+    /// Time since the current search was typed.
+    QElapsedTimer searchTimer;
+
+    /// Results of the current search whose launchers aren't created yet.
+    QList<int> pendingResults;
+
+    /// Set until the first results of the current search are shown.
+    bool searchPending;
+
+    /// Frecency boosts of the applications, computed once per search session.
+    QHash<int, int> boosts;
+
+    /// If the boosts were computed for the current search session.
+    bool boostsValid;
 };
 
 }      // End namespace
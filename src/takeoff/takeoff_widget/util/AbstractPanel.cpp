@@ -0,0 +1,46 @@
+/**
+ * @file /src/takeoff/takeoff_widget/util/AbstractPanel.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  TakeoffPrivate::AbstractPanel
+ */
+#include "AbstractPanel.h"
+using namespace TakeoffPrivate;
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+AbstractPanel::AbstractPanel(QGraphicsWidget *parent)
+        : QGraphicsWidget(parent)
+{
+
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC METHODS                    ********** //
+// ************************************************************************** //
+
+int AbstractPanel::addLaunchers(const QList<Takeoff::LauncherData> &launchers)
+{
+    int n = 0;
+    while (n < launchers.length() && !this->isFull())
+        this->addLauncher(launchers.at(n++));
+
+    return n;
+}
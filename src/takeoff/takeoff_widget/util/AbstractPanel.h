@@ -0,0 +1,138 @@
+/**
+ * @file /src/takeoff/takeoff_widget/util/AbstractPanel.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  TakeoffPrivate::AbstractPanel
+ */
+#ifndef TAKEOFFWIDGET_UTIL_ABSTRACTPANEL_H
+#define TAKEOFFWIDGET_UTIL_ABSTRACTPANEL_H
+
+#include <QtCore/QList>
+#include <QtGui/QGraphicsWidget>
+#include "../Launcher.h"
+class QKeyEvent;
+namespace TakeoffPrivate  {
+
+/**
+ * A page of launchers of a PanelArea. The launchers are placed in a grid of
+ * NUM_ROWS x NUM_COLUMNS cells, see Panel and LauncherGrid. The launchers are
+ * added and taken as Takeoff::LauncherData, each panel decides if it creates
+ * a widget for them.
+ */
+class AbstractPanel : public QGraphicsWidget
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * Default constructor.
+     * @param parent Parent of the widget.
+     */
+    AbstractPanel(QGraphicsWidget *parent = 0);
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Adds a launcher in the first free position. If the panel is full haven't
+     * got effect.
+     * @param launcher The launcher to add.
+     */
+    virtual void addLauncher(const Takeoff::LauncherData &launcher) = 0;
+
+    /**
+     * Adds the launchers in the first free positions, in order. The launchers
+     * that don't fit are not added.
+     * @param  launchers The launchers to add.
+     * @return The number of added launchers.
+     */
+    virtual int addLaunchers(const QList<Takeoff::LauncherData> &launchers);
+
+    /**
+     * Inserts a launcher at the specified position, moving the next ones one
+     * cell forward. If the panel is full haven't got effect.
+     * @param index    The position of the launcher.
+     * @param launcher The launcher to insert.
+     */
+    virtual void insertLauncher(int index,
+            const Takeoff::LauncherData &launcher) = 0;
+
+    /**
+     * Removes the specified launcher from the panel. The next launchers are
+     * moved one cell backward.
+     * @param  index The position of the launcher.
+     * @return The data of the launcher, to add it to another panel.
+     */
+    virtual Takeoff::LauncherData takeLauncher(int index) = 0;
+
+    /**
+     * Removes all the launchers from the panel.
+     * @return The data of the launchers, in order.
+     */
+    virtual QList<Takeoff::LauncherData> takeAllLaunchers() = 0;
+
+    /**
+     * Removes all the launchers.
+     */
+    virtual void removeAllLaunchers() = 0;
+
+    /**
+     * Updates the text of the launchers after a configuration change.
+     */
+    virtual void updateLaunchers() = 0;
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Returns the desktop file of the specified launcher.
+     * @param  index The index of the launcher.
+     * @return The desktop file or an empty string if the launcher is not
+     *         available.
+     */
+    virtual QString getDesktopFile(int index) const = 0;
+
+    /**
+     * Returns the number of launchers of the panel.
+     * @return The number of launchers.
+     */
+    virtual int getNumLaunchers() const = 0;
+
+    /**
+     * Indicates if the panel is full or no.
+     * @return If is full or not.
+     */
+    virtual bool isFull() const = 0;
+
+    /**
+      * Handle Enter/Return and Arrow keys
+      * @param event Keyboard event
+      */
+    virtual void keyPressed(QKeyEvent* event) = 0;
+
+signals:
+
+    /**
+     * Signal that is emitted whenever the user click on one launcher. The
+     * panel handles the clicks of all its launchers, the launchers don't
+     * emit any signal.
+     */
+    void clicked() const;
+
+};
+
+}      // End namespace
+#endif // TAKEOFFWIDGET_UTIL_ABSTRACTPANEL_H
@@ -0,0 +1,337 @@
+/**
+ * @file /src/takeoff/takeoff_widget/util/LauncherGrid.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  TakeoffPrivate::LauncherGrid
+ */
+#include "LauncherGrid.h"
+#include <QtGui/QFontMetrics>
+#include <QtGui/QGraphicsSceneHoverEvent>
+#include <QtGui/QGraphicsSceneMouseEvent>
+#include <QtGui/QKeyEvent>
+#include <QtGui/QPainter>
+#include <KDE/Plasma/ItemBackground>
+#include <KDE/Plasma/Theme>
+#include "../Launcher.h"
+#include "../../model/config/Config.h"
+using namespace TakeoffPrivate;
+
+// ************************************************************************** //
+// **********              CONSTRUCTORS AND DESTRUCTOR             ********** //
+// ************************************************************************** //
+
+LauncherGrid::LauncherGrid(QGraphicsWidget *parent)
+        : AbstractPanel(parent),
+          hoverIndicator(new Plasma::ItemBackground(this)),
+          highlighted(-1),
+          pressed(-1)
+{
+    const Config::Values &cfg = Config::getInstance()->getValues();
+    this->numRows    = cfg.numRows;
+    this->numColumns = cfg.numColumns;
+    this->cellSize   = cfg.launcherSize;
+    this->spacing    = cfg.separationBetweenLaunchers;
+
+    this->setAcceptHoverEvents(true);
+    this->setFlag(QGraphicsItem::ItemHasNoContents, false);
+    this->setFocusPolicy(Qt::StrongFocus);
+
+    this->hoverIndicator->setZValue(-100);
+    this->hoverIndicator->hide();
+}
+
+LauncherGrid::~LauncherGrid()
+{
+    this->removeAllLaunchers();
+}
+
+
+// ************************************************************************** //
+// **********                    PUBLIC METHODS                    ********** //
+// ************************************************************************** //
+
+void LauncherGrid::addLauncher(const Takeoff::LauncherData &launcher)
+{
+    this->insertLauncher(this->cells.length(), launcher);
+}
+
+void LauncherGrid::insertLauncher(int index,
+        const Takeoff::LauncherData &launcher)
+{
+    if (this->isFull())
+        return;
+
+    Metrics::allocate(launcher.subsystem, getMemoryUsage(launcher));
+    this->cells.insert(qMin(index, this->cells.length()), launcher);
+    this->highlight(-1);
+    this->update();
+}
+
+Takeoff::LauncherData LauncherGrid::takeLauncher(int index)
+{
+    Takeoff::LauncherData launcher = this->cells.takeAt(index);
+    Metrics::release(launcher.subsystem, getMemoryUsage(launcher));
+
+    this->highlight(-1);
+    this->update();
+    return launcher;
+}
+
+QList<Takeoff::LauncherData> LauncherGrid::takeAllLaunchers()
+{
+    QList<Takeoff::LauncherData> ret = this->cells;
+    this->removeAllLaunchers();
+    return ret;
+}
+
+void LauncherGrid::removeAllLaunchers()
+{
+    foreach (const Takeoff::LauncherData &cell, this->cells)
+        Metrics::release(cell.subsystem, getMemoryUsage(cell));
+
+    this->cells.clear();
+    this->highlight(-1);
+    this->update();
+}
+
+void LauncherGrid::updateLaunchers()
+{
+    // The text is painted according to the configuration
+    this->update();
+}
+
+void LauncherGrid::keyPressed(QKeyEvent *event)
+{
+    int count = this->cells.length();
+    if (count == 0)
+        return;
+
+    bool isReturn = event->key() == Qt::Key_Enter
+            || event->key() == Qt::Key_Return;
+    if (this->highlighted != -1 && isReturn) {
+        Takeoff::Launcher::runApplication(
+                this->cells.at(this->highlighted).desktopFile);
+        emit this->clicked();
+        return;
+    }
+
+    // Same navigation as Panel::keyPressed(), wrapping in rows and columns
+    if (this->highlighted == -1) {
+        this->highlight(0);
+        return;
+    }
+
+    int panelCols = qMin(count, this->numColumns);
+    int panelRows = (count + this->numColumns - 1) / this->numColumns;
+    int row = this->highlighted / this->numColumns;
+    int col = this->highlighted % this->numColumns;
+
+    switch (event->key()) {
+    case Qt::Key_Down:
+        row = (row + 1) % panelRows;
+        break;
+    case Qt::Key_Up:
+        row = (panelRows + row - 1) % panelRows;
+        break;
+    case Qt::Key_Left:
+        col = (panelCols + col - 1) % panelCols;
+        break;
+    case Qt::Key_Right:
+        col = (col + 1) % panelCols;
+        break;
+    }
+
+    this->highlight(qMin(row * this->numColumns + col, count - 1));
+}
+
+void LauncherGrid::paint(QPainter *painter,
+        const QStyleOptionGraphicsItem */*option*/, QWidget */*widget*/)
+{
+    Plasma::Theme *theme = Plasma::Theme::defaultTheme();
+    bool showText = Config::getInstance()->getValues().showIconText;
+    QFont font = theme->font(Plasma::Theme::DefaultFont);
+    QFontMetrics metrics(font);
+    int textHeight = showText ? metrics.height() : 0;
+
+    painter->setFont(font);
+    painter->setPen(theme->color(Plasma::Theme::TextColor));
+
+    for (int n=0; n<this->cells.length(); n++) {
+        const Takeoff::LauncherData &cell = this->cells.at(n);
+        QRectF rect = this->cellRect(n);
+
+        QRectF iconRect = rect.adjusted(0, 0, 0, -textHeight);
+        cell.icon.paint(painter, iconRect.toRect());
+
+        if (showText) {
+            QRectF textRect(rect.left(), rect.bottom() - textHeight,
+                    rect.width(), textHeight);
+            painter->drawText(textRect, Qt::AlignCenter,
+                    metrics.elidedText(cell.name, Qt::ElideRight,
+                    textRect.width()));
+        }
+    }
+}
+
+
+// ************************************************************************** //
+// **********                  PROTECTED METHODS                   ********** //
+// ************************************************************************** //
+
+QSizeF LauncherGrid::sizeHint(Qt::SizeHint which,
+        const QSizeF &constraint) const
+{
+    if (which == Qt::MinimumSize || which == Qt::PreferredSize) {
+        return QSizeF(
+                this->numColumns * (this->cellSize + this->spacing),
+                this->numRows * (this->cellSize + this->spacing));
+    }
+
+    return AbstractPanel::sizeHint(which, constraint);
+}
+
+void LauncherGrid::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
+{
+    int index = this->indexAt(event->pos());
+    if (index != this->highlighted)
+        this->highlight(index);
+}
+
+void LauncherGrid::hoverLeaveEvent(QGraphicsSceneHoverEvent */*event*/)
+{
+    this->highlight(-1);
+}
+
+void LauncherGrid::mousePressEvent(QGraphicsSceneMouseEvent *event)
+{
+    int index = this->indexAt(event->pos());
+    if (index == -1) {
+        event->ignore();
+        return;
+    }
+
+    if (event->button() == Qt::RightButton) {
+        this->pressed = -1;
+        this->showContextMenu(index);
+    } else {
+        this->pressed = index;
+    }
+}
+
+void LauncherGrid::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
+{
+    // Like a button, the launcher runs if the mouse is released over it
+    int index = this->indexAt(event->pos());
+    if (event->button() == Qt::LeftButton && index != -1
+            && index == this->pressed) {
+        Takeoff::Launcher::runApplication(this->cells.at(index).desktopFile);
+        emit this->clicked();
+    }
+
+    this->pressed = -1;
+}
+
+
+// ************************************************************************** //
+// **********                   PRIVATE METHODS                    ********** //
+// ************************************************************************** //
+
+int LauncherGrid::getMemoryUsage(const Takeoff::LauncherData &cell)
+{
+    return sizeof(Takeoff::LauncherData) + Metrics::sizeOf(cell.name)
+            + Metrics::sizeOf(cell.desktopFile);
+}
+
+void LauncherGrid::showContextMenu(int index)
+{
+    // The actions of the menu belong to a launcher, that only lives while the
+    // menu is shown. The grid could change meanwhile, so the cell is copied
+    Takeoff::Launcher launcher(this->cells.at(index));
+    launcher.showContextMenu();
+}
+
+QRectF LauncherGrid::cellRect(int index) const
+{
+    // The grid is centered horizontally, like the Panel layout
+    int step = this->cellSize + this->spacing;
+    qreal left = (this->size().width() - this->numColumns * step
+            + this->spacing) / 2;
+
+    return QRectF(left + (index % this->numColumns) * step,
+            (index / this->numColumns) * step,
+            this->cellSize, this->cellSize);
+}
+
+int LauncherGrid::indexAt(const QPointF &pos) const
+{
+    int step = this->cellSize + this->spacing;
+    qreal left = (this->size().width() - this->numColumns * step
+            + this->spacing) / 2;
+    qreal x = pos.x() - left;
+    qreal y = pos.y();
+    if (x < 0 || y < 0)
+        return -1;
+
+    // Outside the grid or in the separation between cells
+    int col = int(x) / step;
+    int row = int(y) / step;
+    if (col >= this->numColumns || row >= this->numRows
+            || int(x) % step >= this->cellSize
+            || int(y) % step >= this->cellSize)
+        return -1;
+
+    int index = row * this->numColumns + col;
+    return (index < this->cells.length()) ? index : -1;
+}
+
+void LauncherGrid::highlight(int index)
+{
+    this->highlighted = index;
+
+    if (index == -1) {
+        this->hoverIndicator->hide();
+        this->setToolTip(QString());
+        return;
+    }
+
+    this->hoverIndicator->setTarget(this->cellRect(index));
+    this->hoverIndicator->show();
+    this->setToolTip(this->cells.at(index).name);
+}
+
+
+// ************************************************************************** //
+// **********                      GET/SET/IS                      ********** //
+// ************************************************************************** //
+
+QString LauncherGrid::getDesktopFile(int index) const
+{
+    if (index < 0 || index >= this->cells.length())
+        return QString();
+
+    return this->cells.at(index).desktopFile;
+}
+
+int LauncherGrid::getNumLaunchers() const
+{
+    return this->cells.length();
+}
+
+bool LauncherGrid::isFull() const
+{
+    return this->cells.length() >= this->numColumns * this->numRows;
+}
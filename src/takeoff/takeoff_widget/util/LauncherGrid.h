@@ -0,0 +1,151 @@
+/**
+ * @file /src/takeoff/takeoff_widget/util/LauncherGrid.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  TakeoffPrivate::LauncherGrid
+ */
+#ifndef TAKEOFFWIDGET_UTIL_LAUNCHERGRID_H
+#define TAKEOFFWIDGET_UTIL_LAUNCHERGRID_H
+
+#include <QtCore/QRectF>
+#include "AbstractPanel.h"
+namespace Plasma { class ItemBackground; }
+namespace TakeoffPrivate  {
+
+/**
+ * Page of launchers that paints all of them itself, instead of laying out a
+ * widget per launcher. Only the data to paint and run the launchers is kept,
+ * so adding, taking and moving them between grids doesn't create widgets. The
+ * cell under the mouse is calculated from the position.
+ */
+class LauncherGrid : public AbstractPanel
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * Default constructor.
+     * @param parent Parent of the widget.
+     */
+    LauncherGrid(QGraphicsWidget *parent = 0);
+
+    /**
+     * Deletes itself and all the launchers.
+     */
+    virtual ~LauncherGrid();
+
+    //--------------------------------------------------------------------------
+
+    virtual void addLauncher(const Takeoff::LauncherData &launcher);
+    virtual void insertLauncher(int index,
+            const Takeoff::LauncherData &launcher);
+    virtual Takeoff::LauncherData takeLauncher(int index);
+    virtual QList<Takeoff::LauncherData> takeAllLaunchers();
+    virtual void removeAllLaunchers();
+    virtual void updateLaunchers();
+
+    //--------------------------------------------------------------------------
+
+    virtual QString getDesktopFile(int index) const;
+    virtual int getNumLaunchers() const;
+    virtual bool isFull() const;
+    virtual void keyPressed(QKeyEvent* event);
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * Paints the icons and the names of all the launchers.
+     */
+    virtual void paint(QPainter *painter,
+            const QStyleOptionGraphicsItem *option, QWidget *widget);
+
+protected:
+
+    virtual QSizeF sizeHint(Qt::SizeHint which,
+            const QSizeF &constraint = QSizeF()) const;
+    virtual void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
+    virtual void hoverLeaveEvent(QGraphicsSceneHoverEvent *event);
+    virtual void mousePressEvent(QGraphicsSceneMouseEvent *event);
+    virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent *event);
+
+private:
+
+    /**
+     * Returns the estimated memory used by a cell, without the pixmaps of the
+     * icon.
+     * @param  cell The launcher of the cell.
+     * @return The size in bytes.
+     */
+    static int getMemoryUsage(const Takeoff::LauncherData &cell);
+
+    /**
+     * Shows the context menu of the specified launcher.
+     * @param index The index of the launcher.
+     */
+    void showContextMenu(int index);
+
+    /**
+     * Returns the area of the specified cell.
+     * @param  index The index of the cell.
+     * @return The area, in item coordinates.
+     */
+    QRectF cellRect(int index) const;
+
+    /**
+     * Returns the launcher under the specified position.
+     * @param  pos The position, in item coordinates.
+     * @return The index of the launcher or -1 if there is no launcher.
+     */
+    int indexAt(const QPointF &pos) const;
+
+    /**
+     * Moves the hover indicator to the specified launcher.
+     * @param index The index of the launcher or -1 to hide the indicator.
+     */
+    void highlight(int index);
+
+    //--------------------------------------------------------------------------
+
+    /// Number of rows of the grid.
+    int numRows;
+
+    /// Number of columns of the grid.
+    int numColumns;
+
+    /// Size of each cell.
+    int cellSize;
+
+    /// Separation between the cells.
+    int spacing;
+
+    /// Launchers of the grid, in order.
+    QList<Takeoff::LauncherData> cells;
+
+    /// Indicator of the launcher under the mouse or focused with the keyboard.
+    Plasma::ItemBackground *hoverIndicator;
+
+    /// Highlighted launcher, -1 if none.
+    int highlighted;
+
+    /// Launcher under the mouse when the button was pressed, -1 if none.
+    int pressed;
+
+};
+
+}      // End namespace
+#endif // TAKEOFFWIDGET_UTIL_LAUNCHERGRID_H
@@ -20,7 +20,9 @@
  */
 #include "Panel.h"
 #include <QtCore/QList>
+#include <QtCore/QSet>
 #include <QtGui/QGraphicsGridLayout>
+#include <QtGui/QGraphicsSceneMouseEvent>
 #include <QKeyEvent>
 #include <KDE/Plasma/Label>
 #include "../Launcher.h"
@@ -32,11 +34,12 @@ using namespace TakeoffPrivate;
 // ************************************************************************** //
 
 Panel::Panel(QGraphicsWidget *parent)
-        : QGraphicsWidget(parent),
+        : AbstractPanel(parent),
           panelLayout(new QGraphicsGridLayout(this)),
           focused(false),
           colFocused(-1),
-          rowFocused(-1)
+          rowFocused(-1),
+          pressed(-1)
 {
     // To maintain the plasmoid at fullscreen mode, is necessary to make a hack.
     // This is the structure of the layout:
@@ -52,9 +55,9 @@ Panel::Panel(QGraphicsWidget *parent)
     // The first and the last columns and the last row are separators
     // (Plasma::Label). The first row is another margin.
 
-    Config *cfg = Config::getInstance();
-    this->numRows    = cfg->getSettings(Config::NUM_ROWS).toInt();
-    this->numColumns = cfg->getSettings(Config::NUM_COLUMNS).toInt();
+    const Config::Values &cfg = Config::getInstance()->getValues();
+    this->numRows    = cfg.numRows;
+    this->numColumns = cfg.numColumns;
 
     // Set the separators and the top margin
     Plasma::Label *s1 = new Plasma::Label(this);
@@ -68,7 +71,7 @@ Panel::Panel(QGraphicsWidget *parent)
     this->panelLayout->setRowMaximumHeight(0, 0);
 
     // Set the maximum grid size
-    int itemSize = cfg->getSettings(Config::LAUNCHER_SIZE).toInt();
+    int itemSize = cfg.launcherSize;
 
     for (int n=1; n<=this->numColumns; n++) {
         this->panelLayout->setColumnMaximumWidth(n, itemSize);
@@ -82,13 +85,16 @@ Panel::Panel(QGraphicsWidget *parent)
 
 
     // Set the separation between launchers
-    this->panelLayout->setSpacing(
-        cfg->getSettings(Config::SEPARATION_BETWEEN_LAUNCHERS).toInt());
+    this->panelLayout->setSpacing(cfg.separationBetweenLaunchers);
 
     this->setLayout(this->panelLayout);
 
     setFocusPolicy(Qt::StrongFocus);
 
+    // The clicks on the launchers are handled by the panel, see
+    // sceneEventFilter()
+    this->setFiltersChildEvents(true);
+
     m_hoverIndicator = new Plasma::ItemBackground(this);
     m_hoverIndicator->setZValue(-100);
     m_hoverIndicator->hide();
@@ -104,16 +110,12 @@ Panel::~Panel()
 // **********                    PUBLIC METHODS                    ********** //
 // ************************************************************************** //
 
-void Panel::addLauncher(Takeoff::Launcher *launcher)
+void Panel::addLauncher(const Takeoff::LauncherData &data)
 {
     if (this->isFull())
         return;
 
-    connect(launcher, SIGNAL(clicked()), this, SIGNAL(clicked()));
-    connect(launcher, SIGNAL(addedToFavorites()),
-            this, SIGNAL(addedToFavorites()));
-    connect(launcher, SIGNAL(removedFromFavorites()),
-            this, SIGNAL(removedFromFavorites()));
+    Takeoff::Launcher *launcher = new Takeoff::Launcher(data);
 
     int row    = (this->launchers.length() / numColumns) + 1;
     int column = (this->launchers.length() % numColumns) + 1;
@@ -122,6 +124,77 @@ void Panel::addLauncher(Takeoff::Launcher *launcher)
     this->launchers.append(launcher);
 }
 
+int Panel::addLaunchers(const QList<Takeoff::LauncherData> &launchers)
+{
+    int first = this->launchers.length();
+    int count = qMin(launchers.length(),
+            this->numColumns * this->numRows - first);
+    if (count <= 0)
+        return 0;
+
+    // The invalidations of addItem() only reach the parents when the panel is
+    // already in a PanelArea, so PanelArea fills the new panels before adding
+    // them (see PanelArea::addLaunchers())
+    this->launchers.reserve(first + count);
+    for (int n=0; n<count; n++) {
+        Takeoff::Launcher *launcher = new Takeoff::Launcher(launchers.at(n));
+
+        int index = first + n;
+        this->panelLayout->addItem(launcher, (index / numColumns) + 1,
+                (index % numColumns) + 1, Qt::AlignCenter);
+        this->launchers.append(launcher);
+    }
+
+    return count;
+}
+
+void Panel::insertLauncher(int index, const Takeoff::LauncherData &data)
+{
+    if (this->isFull())
+        return;
+
+    if (index >= this->launchers.length()) {
+        this->addLauncher(data);
+        return;
+    }
+
+    this->launchers.insert(index, new Takeoff::Launcher(data));
+    this->placeLaunchers(index);
+}
+
+Takeoff::LauncherData Panel::takeLauncher(int index)
+{
+    Takeoff::Launcher *launcher = this->launchers.takeAt(index);
+    Takeoff::LauncherData data = launcher->getData();
+    this->discardLauncher(launcher);
+    this->placeLaunchers(index);
+
+    // The focused cell may be empty now
+    if (this->focused) {
+        this->focused = false;
+        this->m_hoverIndicator->hide();
+    }
+    this->pressed = -1;
+
+    return data;
+}
+
+QList<Takeoff::LauncherData> Panel::takeAllLaunchers()
+{
+    QList<Takeoff::LauncherData> ret;
+    ret.reserve(this->launchers.length());
+    foreach (Takeoff::Launcher *launcher, this->launchers) {
+        ret.append(launcher->getData());
+        this->discardLauncher(launcher);
+    }
+    this->launchers.clear();
+
+    this->focused = false;
+    this->m_hoverIndicator->hide();
+    this->pressed = -1;
+    return ret;
+}
+
 void Panel::removeAllLaunchers()
 {
     for (int n=0; n<this->launchers.length(); n++) {
@@ -131,6 +204,12 @@ void Panel::removeAllLaunchers()
     this->launchers.clear();
 }
 
+void Panel::updateLaunchers()
+{
+    foreach (Takeoff::Launcher *launcher, this->launchers)
+        launcher->updateText();
+}
+
 void Panel::keyPressed(QKeyEvent *event)
 {
     if (focused && (event->key() == Qt::Key_Enter || event->key() == Qt::Key_Return))
@@ -170,16 +249,119 @@ void Panel::keyPressed(QKeyEvent *event)
     }
 }
 
+// ************************************************************************** //
+// **********                  PROTECTED METHODS                   ********** //
+// ************************************************************************** //
+
+bool Panel::sceneEventFilter(QGraphicsItem *watched, QEvent *event)
+{
+    if (event->type() != QEvent::GraphicsSceneMousePress
+            && event->type() != QEvent::GraphicsSceneMouseRelease)
+        return false;
+
+    QGraphicsSceneMouseEvent *mouseEvent =
+            static_cast<QGraphicsSceneMouseEvent*>(event);
+    int index = this->indexOf(watched);
+
+    if (event->type() == QEvent::GraphicsSceneMousePress) {
+        this->pressed = -1;
+        if (index == -1)
+            return false;
+
+        if (mouseEvent->button() == Qt::RightButton) {
+            this->launchers.at(index)->showContextMenu();
+            return true;
+        }
+
+        if (mouseEvent->button() == Qt::LeftButton)
+            this->pressed = index;
+        return false;
+    }
+
+    // Like the clicked() signal of the icon, the launcher runs if the mouse is
+    // released over the item that received the press. The event is not
+    // consumed, so the icon is still animated
+    bool isClick = mouseEvent->button() == Qt::LeftButton && index != -1
+            && index == this->pressed
+            && watched->contains(watched->mapFromScene(mouseEvent->scenePos()));
+    this->pressed = -1;
+
+    if (isClick) {
+        this->launchers.at(index)->runApplication();
+        emit this->clicked();
+    }
+
+    return false;
+}
+
+
+// ************************************************************************** //
+// **********                   PRIVATE METHODS                    ********** //
+// ************************************************************************** //
+
+int Panel::indexOf(QGraphicsItem *item) const
+{
+    // Look for the launcher that contains the item
+    while (item != NULL && item->parentItem() != this)
+        item = item->parentItem();
+
+    for (int n=0; item != NULL && n<this->launchers.length(); n++) {
+        if (this->launchers.at(n) == item)
+            return n;
+    }
+
+    return -1;
+}
+
+void Panel::discardLauncher(Takeoff::Launcher *launcher)
+{
+    for (int n=0; n<this->panelLayout->count(); n++) {
+        if (this->panelLayout->itemAt(n) == launcher) {
+            this->panelLayout->removeAt(n);
+            break;
+        }
+    }
+
+    // The launcher could be the sender of the current event, so it is deleted
+    // later and no longer belongs to the panel meanwhile
+    launcher->setParentItem(0);
+    launcher->hide();
+    launcher->deleteLater();
+}
+
+void Panel::placeLaunchers(int from)
+{
+    // QGraphicsGridLayout can't move an item, so it is removed and added again
+    QSet<QGraphicsLayoutItem*> moved;
+    for (int n=from; n<this->launchers.length(); n++)
+        moved.insert(this->launchers.at(n));
+
+    for (int n=this->panelLayout->count()-1; n>=0; n--) {
+        if (moved.contains(this->panelLayout->itemAt(n)))
+            this->panelLayout->removeAt(n);
+    }
+
+    for (int n=from; n<this->launchers.length(); n++) {
+        this->panelLayout->addItem(this->launchers.at(n), (n / numColumns) + 1,
+                (n % numColumns) + 1, Qt::AlignCenter);
+    }
+}
+
 // ************************************************************************** //
 // **********                      GET/SET/IS                      ********** //
 // ************************************************************************** //
 
-Takeoff::Launcher *Panel::getLauncher(int index) const
+QString Panel::getDesktopFile(int index) const
 {
-    if (this->launchers.length() == 0)
-        return NULL;
-    else
-        return this->launchers.at(index);
+    if (index < 0 || index >= this->launchers.length())
+        return QString();
+
+    return this->launchers.at(index)->getDesktopFile();
+}
+
+int Panel::getNumLaunchers() const
+{
+    return this->launchers.length();
 }
 
 bool Panel::isFull() const
@@ -21,17 +21,18 @@
 #ifndef TAKEOFFWIDGET_UTIL_PANEL_H
 #define TAKEOFFWIDGET_UTIL_PANEL_H
 
-#include <QtGui/QGraphicsWidget>
 #include <Plasma/ItemBackground>
+#include "AbstractPanel.h"
 class QGraphicsGridLayout;
 namespace Takeoff { class Launcher; }
 namespace TakeoffPrivate  {
 
 /**
  * Widget that contains a number of launchers, this number will depends of the
- * size of the applet or screen.
+ * size of the applet or screen. A Takeoff::Launcher widget is created for each
+ * added launcher and deleted when it is taken.
  */
-class Panel : public QGraphicsWidget
+class Panel : public AbstractPanel
 {
     Q_OBJECT
 
@@ -55,52 +56,112 @@ public:
      * got effect.
      * @param launcher The launcher to add.
      */
-    void addLauncher(Takeoff::Launcher *launcher);
+    virtual void addLauncher(const Takeoff::LauncherData &launcher);
+
+    /**
+     * Adds the launchers in the first free positions, in order. The launchers
+     * that don't fit are not added.
+     * @param  launchers The launchers to add.
+     * @return The number of added launchers.
+     */
+    virtual int addLaunchers(const QList<Takeoff::LauncherData> &launchers);
+
+    /**
+     * Inserts a launcher at the specified position, moving the next ones one
+     * cell forward. If the panel is full haven't got effect.
+     * @param index    The position of the launcher.
+     * @param launcher The launcher to insert.
+     */
+    virtual void insertLauncher(int index,
+            const Takeoff::LauncherData &launcher);
+
+    /**
+     * Removes the specified launcher from the panel and deletes its widget
+     * when control returns to the event loop. The next launchers are moved one
+     * cell backward.
+     * @param  index The position of the launcher.
+     * @return The data of the launcher.
+     */
+    virtual Takeoff::LauncherData takeLauncher(int index);
+
+    /**
+     * Removes all the launchers from the panel, like takeLauncher().
+     * @return The data of the launchers, in order.
+     */
+    virtual QList<Takeoff::LauncherData> takeAllLaunchers();
 
     /**
      * Removes all the launchers.
      */
-    void removeAllLaunchers();
+    virtual void removeAllLaunchers();
+
+    /**
+     * Updates the text of the launchers after a configuration change.
+     */
+    virtual void updateLaunchers();
 
     //--------------------------------------------------------------------------
 
     /**
-     * Returns the specified launcher or NULL if any launcher is not available.
+     * Returns the desktop file of the specified launcher.
      * @param  index The index of the launcher.
-     * @return The launcher.
+     * @return The desktop file or an empty string if the launcher is not
+     *         available.
      */
-    Takeoff::Launcher *getLauncher(int index) const;
+    virtual QString getDesktopFile(int index) const;
+
+    /**
+     * Returns the number of launchers of the panel.
+     * @return The number of launchers.
+     */
+    virtual int getNumLaunchers() const;
 
     /**
      * Indicates if the panel is full (have 32 launchers) or no.
      * @return If is full or not.
      */
-    bool isFull() const;
+    virtual bool isFull() const;
 
     /**
       * Handle Enter/Return and Arrow keys
       * @param event Keyboard event
       */
-    void keyPressed(QKeyEvent* event);
+    virtual void keyPressed(QKeyEvent* event);
 
-signals:
+protected:
 
     /**
-     * Signal that is emitted whenever the user click on one launcher.
+     * Handles the mouse events of the launchers, so the panel runs them or
+     * shows their context menu without a connection per launcher.
+     * @param  watched The item that receives the event.
+     * @param  event   The event.
+     * @return If the event was consumed.
      */
-    void clicked() const;
+    virtual bool sceneEventFilter(QGraphicsItem *watched, QEvent *event);
+
+private:
 
     /**
-     * Signal that is emitted when a launcher is added to favorites.
+     * Returns the launcher that contains the specified item.
+     * @param  item The launcher or one of its children.
+     * @return The index of the launcher or -1 if it isn't in the panel.
      */
-    void addedToFavorites() const;
+    int indexOf(QGraphicsItem *item) const;
 
     /**
-     * Signal that is emitted when a launcher is removed from favorites.
+     * Removes a launcher from the layout and deletes it when control returns
+     * to the event loop, because it could be handling the current event.
+     * @param launcher The launcher.
      */
-    void removedFromFavorites() const;
+    void discardLauncher(Takeoff::Launcher *launcher);
 
-private:
+    /**
+     * Moves the launchers from the specified position to their cells.
+     * @param from Position of the first launcher to move.
+     */
+    void placeLaunchers(int from);
+
+    //--------------------------------------------------------------------------
 
     /// Layout to add the different Launchers.
     QGraphicsGridLayout *panelLayout;
@@ -126,6 +187,9 @@ private:
     /// The row of current focused item, -1 if none
     int rowFocused;
 
+    /// Launcher that received the last left button press, -1 if none
+    int pressed;
+
 };
 
 }      // End namespace
@@ -0,0 +1,120 @@
+/**
+ * @file /src/takeoff/trace/Trace.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  Trace
+ */
+#include "Trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/**
+ * Destination of the events. The file is opened with the first event and the
+ * events are flushed one by one, so a crash doesn't lose the trace. The
+ * closing bracket of the array is optional in the trace event format.
+ */
+struct TraceFile {
+    QMutex mutex;
+    FILE *file;
+    QElapsedTimer clock;
+    bool failed;
+
+    TraceFile() : file(NULL), failed(false) { this->clock.start(); }
+};
+
+TraceFile *traceFile()
+{
+    static TraceFile *instance = new TraceFile;
+    return instance;
+}
+
+/**
+ * Writes an event, with the mutex locked.
+ */
+void writeEvent(const char *name, char phase, qint64 start, qint64 duration)
+{
+    TraceFile *trace = traceFile();
+    QMutexLocker locker(&trace->mutex);
+    if (trace->failed)
+        return;
+
+    if (trace->file == NULL) {
+        trace->file = ::fopen(::getenv("TAKEOFF_TRACE"), "w");
+        if (trace->file == NULL) {
+            trace->failed = true;
+            return;
+        }
+        ::fputs("[\n", trace->file);
+    }
+
+    // Only the names given by the code are written, they don't need escaping
+    unsigned long long tid = (quintptr)QThread::currentThreadId();
+    if (phase == 'X') {
+        ::fprintf(trace->file, "{\"name\":\"%s\",\"cat\":\"takeoff\","
+                "\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%d,"
+                "\"tid\":%llu},\n", name, (long long)start,
+                (long long)duration, (int)::getpid(), tid);
+    } else {
+        ::fprintf(trace->file, "{\"name\":\"%s\",\"cat\":\"takeoff\","
+                "\"ph\":\"i\",\"s\":\"t\",\"ts\":%lld,\"pid\":%d,"
+                "\"tid\":%llu},\n", name, (long long)start,
+                (int)::getpid(), tid);
+    }
+    ::fflush(trace->file);
+}
+
+}
+
+
+// ************************************************************************** //
+// **********             STATIC METHODS AND VARIABLES             ********** //
+// ************************************************************************** //
+
+bool Trace::enabled = ::getenv("TAKEOFF_TRACE") != NULL
+        && *::getenv("TAKEOFF_TRACE") != '\0';
+
+qint64 Trace::now()
+{
+    return traceFile()->clock.nsecsElapsed() / 1000;
+}
+
+void Trace::addSpan(const char *name, qint64 start)
+{
+    if (!Trace::enabled)
+        return;
+
+    qint64 end = now();
+    writeEvent(name, 'X', start, end - start);
+}
+
+void Trace::addInstant(const char *name)
+{
+    if (!Trace::enabled)
+        return;
+
+    writeEvent(name, 'i', now(), 0);
+}
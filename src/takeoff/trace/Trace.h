@@ -0,0 +1,120 @@
+/**
+ * @file /src/takeoff/trace/Trace.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  Trace
+ */
+#ifndef TRACE_TRACE_H
+#define TRACE_TRACE_H
+
+#include <QtCore/QtGlobal>
+
+/**
+ * Records where the time goes, in the Chrome trace event format. Set the
+ * TAKEOFF_TRACE environment variable to the path of the file to write before
+ * starting plasma-desktop and open the file in chrome://tracing.
+ *
+ * When the variable is not set the spans only check a boolean.
+ */
+class Trace
+{
+
+public:
+
+    /**
+     * Indicates if the events are being recorded.
+     * @return If the trace is enabled.
+     */
+    static inline bool isEnabled() { return Trace::enabled; }
+
+    /**
+     * Returns the time since the trace started.
+     * @return The time in microseconds.
+     */
+    static qint64 now();
+
+    /**
+     * Records a span that has finished.
+     * @param name  Name of the span. Must be a string literal.
+     * @param start Time when the span started, see now().
+     */
+    static void addSpan(const char *name, qint64 start);
+
+    /**
+     * Records an event without duration.
+     * @param name Name of the event. Must be a string literal.
+     */
+    static void addInstant(const char *name);
+
+private:
+
+    /// Indicates if the trace is enabled, read from the environment.
+    static bool enabled;
+
+};
+
+/**
+ * Span of time that lasts until the object is destroyed. Use it through
+ * TAKEOFF_TRACE_SPAN, the nested spans are shown as children.
+ */
+class TraceSpan
+{
+
+public:
+
+    /**
+     * Starts the span if the trace is enabled.
+     * @param name Name of the span. Must be a string literal.
+     */
+    inline TraceSpan(const char *name)
+            : name(name),
+              start(Trace::isEnabled() ? Trace::now() : -1)
+    {
+
+    }
+
+    /**
+     * Records the span.
+     */
+    inline ~TraceSpan()
+    {
+        if (this->start >= 0)
+            Trace::addSpan(this->name, this->start);
+    }
+
+private:
+
+    /// Name of the span.
+    const char *name;
+
+    /// Start time, -1 if the trace is disabled.
+    qint64 start;
+
+    // Hide copy constructors
+    TraceSpan(const TraceSpan&);
+    const TraceSpan &operator = (const TraceSpan&);
+
+};
+
+#define TAKEOFF_TRACE_CONCAT_(a, b) a ## b
+#define TAKEOFF_TRACE_CONCAT(a, b)  TAKEOFF_TRACE_CONCAT_(a, b)
+
+/// Records a span from this line to the end of the scope.
+#define TAKEOFF_TRACE_SPAN(name) \
+        TraceSpan TAKEOFF_TRACE_CONCAT(takeoffTraceSpan, __LINE__)(name)
+
+#endif // TRACE_TRACE_H
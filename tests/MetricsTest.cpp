@@ -0,0 +1,200 @@
+/**
+ * @file /tests/MetricsTest.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  MetricsTest
+ */
+#include "MetricsTest.h"
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QTextStream>
+#include <KDE/KTempDir>
+#include <qtest_kde.h>
+#include "../src/takeoff/metrics/Metrics.h"
+#include "../src/takeoff/model/config/Config.h"
+#include "../src/takeoff/model/menu/Menu.h"
+#include "../src/takeoff/model/menu/MenuBackend.h"
+#include "../src/takeoff/model/menu/qtxdg/xdgdesktopfile.h"
+#include "../src/takeoff/model/menu/qtxdg/xdgmenu.h"
+
+QTEST_KDEMAIN(MetricsTest, GUI)
+
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/// Number of applications of the menu.
+const int NUM_ENTRIES = 5000;
+
+/// Maximum bytes of the DOM per application.
+const int MAX_DOM_BYTES = 4 * 1024;
+
+/// Maximum bytes of a cached desktop file.
+const int MAX_DESKTOP_FILE_BYTES = 8 * 1024;
+
+/// Maximum bytes of a launcher.
+const int MAX_LAUNCHER_BYTES = 2 * 1024;
+
+/// Prefix of the menu file, so it is found as the menu of the system.
+const char *MENU_PREFIX = "takeoff-test-";
+
+/**
+ * Writes a text file.
+ * @param  path The path of the file.
+ * @param  text The contents.
+ * @return If the file was written.
+ */
+bool writeFile(const QString &path, const QString &text)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    stream << text;
+    return true;
+}
+
+/**
+ * Returns the name of a test application.
+ * @param  index The index of the application.
+ * @return The name.
+ */
+QString applicationName(int index)
+{
+    return QString("Application %1").arg(index);
+}
+
+}
+
+
+// ************************************************************************** //
+// **********                    PRIVATE SLOTS                     ********** //
+// ************************************************************************** //
+
+void MetricsTest::initTestCase()
+{
+    this->directory = new KTempDir;
+    QVERIFY(this->directory->exists());
+    QString dir = this->directory->name();
+
+    for (int n=0; n<NUM_ENTRIES; n++) {
+        QString desktopFile = QString(
+                "[Desktop Entry]\n"
+                "Type=Application\n"
+                "Name=%1\n"
+                "GenericName=Test application\n"
+                "Comment=Application %2 of the synthetic menu\n"
+                "Keywords=test;synthetic;\n"
+                "Exec=test-application-%2 %U\n"
+                "Icon=application-x-executable\n"
+                "Categories=Utility;\n")
+                .arg(applicationName(n)).arg(n);
+        QVERIFY(writeFile(dir + QString("test-%1.desktop").arg(n),
+                desktopFile));
+    }
+
+    QString menuFile = QString(
+            "<!DOCTYPE Menu PUBLIC \"-//freedesktop//DTD Menu 1.0//EN\"\n"
+            " \"http://www.freedesktop.org/standards/menu-spec/1.0/menu.dtd\">\n"
+            "<Menu>\n"
+            "  <Name>Applications</Name>\n"
+            "  <AppDir>%1</AppDir>\n"
+            "  <Menu>\n"
+            "    <Name>Utility</Name>\n"
+            "    <Include><Category>Utility</Category></Include>\n"
+            "  </Menu>\n"
+            "</Menu>\n").arg(dir);
+    QVERIFY(writeFile(dir + "test.menu", menuFile));
+
+    // The same menu in the config directory, for Menu
+    QVERIFY(QDir(dir).mkdir("menus"));
+    QVERIFY(writeFile(dir + "menus/" + MENU_PREFIX + "applications.menu",
+            menuFile));
+}
+
+void MetricsTest::cleanupTestCase()
+{
+    delete this->directory;
+}
+
+void MetricsTest::menu()
+{
+    XdgDesktopFileCache::clear();
+    QCOMPARE(Metrics::getBytes(Metrics::XDG_MENU_DOM), 0);
+
+    XdgMenu *menu = new XdgMenu;
+    menu->environments() << "KDE";
+    QVERIFY(menu->read(this->directory->name() + "test.menu"));
+
+    int domBytes = Metrics::getBytes(Metrics::XDG_MENU_DOM);
+    QVERIFY(domBytes > 0);
+    QVERIFY(domBytes <= NUM_ENTRIES * MAX_DOM_BYTES);
+
+    // Every desktop file is read once while the menu is resolved
+    QCOMPARE(Metrics::getObjects(Metrics::DESKTOP_FILE_CACHE), NUM_ENTRIES);
+    QVERIFY(Metrics::getBytes(Metrics::DESKTOP_FILE_CACHE)
+            <= NUM_ENTRIES * MAX_DESKTOP_FILE_BYTES);
+
+    // The DOM is released as soon as the menu has been read, see Menu
+    menu->unload();
+    QCOMPARE(Metrics::getBytes(Metrics::XDG_MENU_DOM), 0);
+    QCOMPARE(Metrics::getObjects(Metrics::XDG_MENU_DOM), 0);
+    delete menu;
+
+    XdgDesktopFileCache::clear();
+    QCOMPARE(Metrics::getBytes(Metrics::DESKTOP_FILE_CACHE), 0);
+    QCOMPARE(Metrics::getObjects(Metrics::DESKTOP_FILE_CACHE), 0);
+}
+
+void MetricsTest::launchers()
+{
+    QCOMPARE(Metrics::getBytes(Metrics::LAUNCHERS), 0);
+
+    // The menu of the fixture is read as the menu of the system
+    QByteArray configDirs = qgetenv("XDG_CONFIG_DIRS");
+    QByteArray menuPrefix = qgetenv("XDG_MENU_PREFIX");
+    qputenv("XDG_CONFIG_DIRS", QFile::encodeName(this->directory->name()));
+    qputenv("XDG_MENU_PREFIX", MENU_PREFIX);
+    Config::getInstance()->setSettings(Config::MENU_BACKEND, MenuBackend::XDG);
+    Config::loadConfig();
+
+    Menu *menu = Menu::getInstance();
+    QCOMPARE(menu->getAllApplications()->length(), NUM_ENTRIES);
+
+    // What the applet keeps for each application once the menu is built
+    QCOMPARE(Metrics::getObjects(Metrics::LAUNCHERS), NUM_ENTRIES);
+    QVERIFY(Metrics::getBytes(Metrics::LAUNCHERS)
+            <= NUM_ENTRIES * MAX_LAUNCHER_BYTES);
+    QCOMPARE(Metrics::getBytes(Metrics::XDG_MENU_DOM), 0);
+
+    int keptBytes = 0;
+    for (int n=0; n<Metrics::NUM_SUBSYSTEMS; n++)
+        keptBytes += Metrics::getBytes((Metrics::Subsystem)n);
+    QVERIFY(keptBytes
+            <= NUM_ENTRIES * (MAX_LAUNCHER_BYTES + MAX_DESKTOP_FILE_BYTES));
+
+    // Reloading the menu releases the launchers of the previous one
+    Menu::loadMenu();
+    QCOMPARE(Metrics::getObjects(Metrics::LAUNCHERS), NUM_ENTRIES);
+
+    qputenv("XDG_CONFIG_DIRS", configDirs);
+    qputenv("XDG_MENU_PREFIX", menuPrefix);
+}
@@ -0,0 +1,56 @@
+/**
+ * @file /tests/MetricsTest.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  MetricsTest
+ */
+#ifndef TESTS_METRICSTEST_H
+#define TESTS_METRICSTEST_H
+
+#include <QtCore/QObject>
+class KTempDir;
+
+/**
+ * Tests of the memory accounted by each subsystem with a synthetic menu of
+ * 5,000 applications.
+ */
+class MetricsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    /// Writes the desktop files and the menu file.
+    void initTestCase();
+
+    /// Removes the files.
+    void cleanupTestCase();
+
+    /// The DOM of the menu and the desktop files cached while it is resolved.
+    void menu();
+
+    /// The launchers that Menu keeps for the applications of the menu.
+    void launchers();
+
+private:
+
+    /// Directory of the desktop files and the menu file.
+    KTempDir *directory;
+
+};
+
+#endif // TESTS_METRICSTEST_H
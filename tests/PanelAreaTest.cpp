@@ -0,0 +1,306 @@
+/**
+ * @file /tests/PanelAreaTest.cpp
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  PanelAreaTest
+ */
+#include "PanelAreaTest.h"
+#include <QtCore/QCoreApplication>
+#include <QtCore/QStringList>
+#include <QtGui/QGraphicsScene>
+#include <qtest_kde.h>
+#include "../src/takeoff/metrics/Metrics.h"
+#include "../src/takeoff/model/config/Config.h"
+#include "../src/takeoff/takeoff_widget/Launcher.h"
+#include "../src/takeoff/takeoff_widget/menu/PanelArea.h"
+#include "../src/takeoff/takeoff_widget/util/AbstractPanel.h"
+using namespace Takeoff;
+using namespace TakeoffPrivate;
+
+QTEST_KDEMAIN(PanelAreaTest, GUI)
+
+// ************************************************************************** //
+// **********                        OTHERS                        ********** //
+// ************************************************************************** //
+
+namespace {
+
+/// Number of launchers of the area, more than the cells of a panel.
+const int NUM_LAUNCHERS = 20;
+
+/// Number of cells of a panel, see PanelAreaTest::initTestCase().
+const int PANEL_SIZE = 6;
+
+/**
+ * Returns the desktop file of a test launcher.
+ * @param  index The index of the launcher.
+ * @return The desktop file.
+ */
+QString desktopFile(int index)
+{
+    return QString("test-%1.desktop").arg(index);
+}
+
+/**
+ * Changes the size of the panels.
+ * @param rows    Number of rows.
+ * @param columns Number of columns.
+ */
+void setPanelSize(int rows, int columns)
+{
+    Config *cfg = Config::getInstance();
+    cfg->setSettings(Config::NUM_ROWS, rows);
+    cfg->setSettings(Config::NUM_COLUMNS, columns);
+    Config::loadConfig();
+}
+
+/**
+ * Changes the kind of the panels.
+ * @param singlePainterGrid If the panels are LauncherGrid.
+ */
+void setSinglePainterGrid(bool singlePainterGrid)
+{
+    Config::getInstance()->setSettings(Config::SINGLE_PAINTER_GRID,
+            singlePainterGrid);
+    Config::loadConfig();
+}
+
+/**
+ * Returns the desktop files of the first test launchers.
+ * @param  count The number of launchers.
+ * @return The desktop files, in order.
+ */
+QStringList desktopFiles(int count)
+{
+    QStringList ret;
+    for (int n=0; n<count; n++)
+        ret.append(desktopFile(n));
+
+    return ret;
+}
+
+/**
+ * Creates an area with test launchers.
+ * @param  scene The scene of the area.
+ * @param  count The number of launchers.
+ * @return The area.
+ */
+PanelArea *createArea(QGraphicsScene *scene, int count)
+{
+    PanelArea *area = new PanelArea;
+    scene->addItem(area);
+
+    QList<LauncherData> launchers;
+    for (int n=0; n<count; n++)
+        launchers.append(LauncherData(QIcon(), QString::number(n),
+                desktopFile(n)));
+    area->addLaunchers(launchers);
+
+    return area;
+}
+
+/**
+ * Shows each panel of an area and checks that it contains its page of the
+ * expected launchers.
+ * @param area     The area.
+ * @param expected The desktop files of the launchers, in order.
+ */
+void comparePanels(PanelArea *area, const QStringList &expected)
+{
+    int numPanels = (expected.length() + PANEL_SIZE - 1) / PANEL_SIZE;
+    QCOMPARE(area->getNumPanels(), numPanels);
+
+    for (int n=0; n<numPanels; n++) {
+        area->setCurrentPanel(n);
+        AbstractPanel *panel = area->getPanel(n);
+        QStringList page = expected.mid(n * PANEL_SIZE, PANEL_SIZE);
+
+        QCOMPARE(panel->getNumLaunchers(), page.length());
+        for (int m=0; m<page.length(); m++)
+            QCOMPARE(panel->getDesktopFile(m), page.at(m));
+    }
+
+    for (int n=0; n<expected.length(); n++)
+        QCOMPARE(area->getDesktopFile(n), expected.at(n));
+    QVERIFY(area->getDesktopFile(expected.length()).isEmpty());
+}
+
+/**
+ * Returns the first launcher of the specified panel.
+ * @param  area  The area.
+ * @param  index The index of the panel.
+ * @return The desktop file or an empty string if the panel doesn't exist.
+ */
+QString firstOfPanel(PanelArea *area, int index)
+{
+    AbstractPanel *panel = area->getPanel(index);
+    return (panel != NULL) ? panel->getDesktopFile(0) : QString();
+}
+
+/**
+ * Returns the number of launcher widgets of a scene.
+ * @param  scene The scene.
+ * @return The number of Launcher widgets.
+ */
+int countLauncherWidgets(const QGraphicsScene &scene)
+{
+    int count = 0;
+    foreach (QGraphicsItem *item, scene.items()) {
+        if (item->isWidget()
+                && qobject_cast<Launcher*>(static_cast<QGraphicsWidget*>(item)))
+            count++;
+    }
+
+    return count;
+}
+
+}
+
+
+// ************************************************************************** //
+// **********                    PRIVATE SLOTS                     ********** //
+// ************************************************************************** //
+
+void PanelAreaTest::initTestCase()
+{
+    setPanelSize(2, 3);
+}
+
+void PanelAreaTest::repage_data()
+{
+    QTest::addColumn<bool>("singlePainterGrid");
+    QTest::newRow("Panel")        << false;
+    QTest::newRow("LauncherGrid") << true;
+}
+
+void PanelAreaTest::repage()
+{
+    QFETCH(bool, singlePainterGrid);
+    setSinglePainterGrid(singlePainterGrid);
+
+    QGraphicsScene scene;
+    PanelArea *area = createArea(&scene, NUM_LAUNCHERS);
+
+    // Fewer and bigger panels, and then back to the first size
+    setPanelSize(3, 4);
+    area->repage();
+    setPanelSize(2, 3);
+    area->repage();
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+
+    for (int n=0; n<NUM_LAUNCHERS; n++)
+        QCOMPARE(area->getDesktopFile(n), desktopFile(n));
+    QVERIFY(area->getDesktopFile(NUM_LAUNCHERS).isEmpty());
+
+    // The grid keeps only the data of the launchers, the panel creates a
+    // widget for each one
+    QCOMPARE(countLauncherWidgets(scene),
+            singlePainterGrid ? 0 : NUM_LAUNCHERS);
+
+    // Change the kind of the panels
+    setSinglePainterGrid(!singlePainterGrid);
+    area->repage();
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+
+    for (int n=0; n<NUM_LAUNCHERS; n++)
+        QCOMPARE(area->getDesktopFile(n), desktopFile(n));
+
+    QCOMPARE(countLauncherWidgets(scene),
+            singlePainterGrid ? NUM_LAUNCHERS : 0);
+
+    // The panels own the launchers
+    delete area;
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+    QCOMPARE(Metrics::getBytes(Metrics::LAUNCHERS), 0);
+    QCOMPARE(Metrics::getObjects(Metrics::LAUNCHERS), 0);
+}
+
+void PanelAreaTest::insertLauncher_data()
+{
+    QTest::addColumn<bool>("singlePainterGrid");
+    QTest::addColumn<int>("index");
+    QTest::newRow("Panel, start")         << false << 0;
+    QTest::newRow("Panel, middle")        << false << PANEL_SIZE + 2;
+    QTest::newRow("Panel, end")           << false << 3 * PANEL_SIZE;
+    QTest::newRow("LauncherGrid, start")  << true  << 0;
+    QTest::newRow("LauncherGrid, middle") << true  << PANEL_SIZE + 2;
+    QTest::newRow("LauncherGrid, end")    << true  << 3 * PANEL_SIZE;
+}
+
+void PanelAreaTest::insertLauncher()
+{
+    QFETCH(bool, singlePainterGrid);
+    QFETCH(int, index);
+    setSinglePainterGrid(singlePainterGrid);
+
+    QGraphicsScene scene;
+    PanelArea *area = createArea(&scene, 3 * PANEL_SIZE);
+    QStringList expected = desktopFiles(3 * PANEL_SIZE);
+
+    int next = index / PANEL_SIZE + 1;
+    QString nextFirst = firstOfPanel(area, next);
+
+    area->insertLauncher(index, LauncherData(QIcon(), "new", "new.desktop"));
+    expected.insert(index, "new.desktop");
+
+    // Only the panel of the launcher changes until the next one is shown
+    QCOMPARE(firstOfPanel(area, next), nextFirst);
+
+    comparePanels(area, expected);
+
+    delete area;
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+}
+
+void PanelAreaTest::removeLauncher_data()
+{
+    QTest::addColumn<bool>("singlePainterGrid");
+    QTest::addColumn<int>("index");
+    QTest::newRow("Panel, start")         << false << 0;
+    QTest::newRow("Panel, middle")        << false << PANEL_SIZE + 2;
+    QTest::newRow("Panel, end")           << false << 3 * PANEL_SIZE;
+    QTest::newRow("LauncherGrid, start")  << true  << 0;
+    QTest::newRow("LauncherGrid, middle") << true  << PANEL_SIZE + 2;
+    QTest::newRow("LauncherGrid, end")    << true  << 3 * PANEL_SIZE;
+}
+
+void PanelAreaTest::removeLauncher()
+{
+    QFETCH(bool, singlePainterGrid);
+    QFETCH(int, index);
+    setSinglePainterGrid(singlePainterGrid);
+
+    QGraphicsScene scene;
+    PanelArea *area = createArea(&scene, 3 * PANEL_SIZE + 1);
+    QStringList expected = desktopFiles(3 * PANEL_SIZE + 1);
+
+    int next = index / PANEL_SIZE + 1;
+    QString nextFirst = firstOfPanel(area, next);
+
+    area->removeLauncher(index);
+    expected.removeAt(index);
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+
+    // Only the panel of the launcher changes until the next one is shown
+    if (next < area->getNumPanels())
+        QCOMPARE(firstOfPanel(area, next), nextFirst);
+
+    comparePanels(area, expected);
+
+    delete area;
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+}
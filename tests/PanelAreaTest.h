@@ -0,0 +1,59 @@
+/**
+ * @file /tests/PanelAreaTest.h
+ *
+ * This file is part of Takeoff.
+ *
+ * Takeoff is free software:  you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License  as  published by  the  Free Software
+ * Foundation,  either version 3 of the License,  or (at your option)  any later
+ * version.
+ *
+ * Takeoff is distributed in  the hope that it will be useful,  but  WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the  GNU General Public License  for more details.
+ *
+ * You should have received a copy of the  GNU General Public License along with
+ * Takeoff. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author José Expósito <jose.exposito89@gmail.com> (C) 2011
+ * @class  PanelAreaTest
+ */
+#ifndef TESTS_PANELAREATEST_H
+#define TESTS_PANELAREATEST_H
+
+#include <QtCore/QObject>
+
+/**
+ * Tests of PanelArea that move the launchers between panels.
+ */
+class PanelAreaTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    /// Uses small panels, so the launchers are spread on several of them.
+    void initTestCase();
+
+    /// Both kinds of panels.
+    void repage_data();
+
+    /// Places the launchers of a populated area in panels of other size.
+    void repage();
+
+    /// Both kinds of panels, inserting at the start, middle and end.
+    void insertLauncher_data();
+
+    /// Inserts a launcher in an area of full panels, so a panel is added.
+    void insertLauncher();
+
+    /// Both kinds of panels, removing from the start, middle and end.
+    void removeLauncher_data();
+
+    /// Removes a launcher from an area with one launcher in the last panel,
+    /// so the last panel is removed.
+    void removeLauncher();
+
+};
+
+#endif // TESTS_PANELAREATEST_H